@@ -10,34 +10,63 @@
  */
 #include "checker.hpp"
 #include "symbol_table.hpp"
+#include "stack_segment.hpp"
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <string>
+#include <thread>
+#include <utility>
 
-Checker::Checker(Node ast) {
-    expAST = ast;
+bool Dependency::operator<(const Dependency &other) const {
+    if(kind != other.kind) {
+        return kind < other.kind;
+    }
+    if(clazz != other.clazz) {
+        return clazz < other.clazz;
+    }
+    return id < other.id;
 }
 
-Node Checker::get_expanded_AST() {
+Checker::Checker(Node ast, int j, bool incr, Checker *p) {
+    expAST = std::move(ast);
+    jobs = j;
+    incremental = incr || p != nullptr;
+    previous = p;
+    renumbered = false;
+    next_checked = 0;
+    reused = 0;
+}
+
+Node &Checker::get_expanded_AST() {
     return expAST;
 }
 
 std::vector<Error> Checker::get_errors() {
-    std::sort(error_vector.begin(), error_vector.end(), Error::compare);
+    std::stable_sort(error_vector.begin(), error_vector.end(), Error::compare);
     return error_vector;
 }
 
+size_t Checker::get_reused_count() const {
+    return reused;
+}
+
+size_t Checker::get_method_count() const {
+    return methods.size();
+}
+
 int Checker::check() {
     SymbolTable* s = SymbolTable::getInstance();
+    s->clear(); // The SymbolTable may still hold the AST of a previous Checker
 
     // Populate the symbol table with clazz definition
     for(auto &clazz : expAST.get_children(NodeType::clazz)) {
-        Node ret = s->add_clazz_to_definition(clazz);
-        if(!ret.is_empty()) {
+        const Node *ret = s->add_clazz_to_definition(clazz);
+        if(ret != nullptr) {
             error_vector.emplace_back(ErrorType::semantical, clazz.get_line(), 
                 clazz.get_column(), clazz.get_data(DataType::id) + " has already be defined at " 
-                + std::to_string(ret.get_line()) + ":" + std::to_string(ret.get_column())); 
+                + std::to_string(ret->get_line()) + ":" + std::to_string(ret->get_column())); 
         }
     }
 
@@ -45,40 +74,64 @@ int Checker::check() {
     if(s->cyclic_clazz_definition() != 0) {
         for(auto &node : s->get_cycle()) {
             // report error for all node referencing a cycle
-            error_vector.emplace_back(ErrorType::semantical, node.get_line(), node.get_column(), 
-                "Class cannot extend " + node.get_data(DataType::parent_id) + " because it references a cycle");
+            error_vector.emplace_back(ErrorType::semantical, node->get_line(), node->get_column(), 
+                "Class cannot extend " + node->get_data(DataType::parent_id) + " because it references a cycle");
         }
     }
 
     // Check for undefined class inheritance 
-    std::vector<Node> undef_parent = s->get_undefined_parents();
+    std::vector<const Node *> undef_parent = s->get_undefined_parents();
     for(auto &clazz : undef_parent) {
-        error_vector.emplace_back(ErrorType::semantical, clazz.get_line(), clazz.get_column(),
-            clazz.get_data(DataType::id) + " attempts to inherits an undefined class: " + clazz.get_data(DataType::parent_id));
+        error_vector.emplace_back(ErrorType::semantical, clazz->get_line(), clazz->get_column(),
+            clazz->get_data(DataType::id) + " attempts to inherits an undefined class: " + clazz->get_data(DataType::parent_id));
     }
 
+    // Number the validated hierarchy for constant time subtyping checks
+    s->build_hierarchy();
+
     // Build symbol table with fileds and methods
     build();
 
+    // Name the clazz numbers, so that a later Checker can translate the reused types
+    if(incremental) {
+        for(size_t i = 0; i < s->get_clazz_count(); ++i) {
+            type_names.push_back(s->get_type_name(TypeRef::clazz(i)));
+        }
+    }
+
+    // Hash the methods with their checked signature, before their bodies are annotated
+    for(auto &clazz : expAST.get_children(NodeType::clazz)) {
+        for(auto &method : clazz.get_children(NodeType::method)) {
+            methods.emplace_back(clazz.get_data(DataType::id), &method);
+            records.emplace_back();
+            if(incremental) {
+                records.back().hash = method.hash(method.get_line());
+                record_index[clazz.get_data(DataType::id) + "." + method.get_data(DataType::id)] = records.size() - 1;
+            }
+        }
+    }
+
     // Main class, main() method check
-    Node main = s->get_main_method();
-    if(main.is_empty()) {
+    const Node *main = s->get_main_method();
+    if(main == nullptr) {
         error_vector.emplace_back(ErrorType::semantical, 1, 1, "Class 'Main' should be defined");
     } else {
-        std::vector<Node> formals = main.get_children(NodeType::formal);
+        const std::vector<Node> &formals = main->get_children(NodeType::formal);
         if(!formals.empty()) {
             error_vector.emplace_back(ErrorType::semantical, formals.begin()->get_line(), formals.begin()->get_column(),
                 "Method 'main' should not contain any formal");
         }
 
-        if(main.get_data(DataType::type).compare("int32") != 0) {
-            error_vector.emplace_back(ErrorType::semantical, main.get_line(), main.get_column(), 
+        if(main->get_type_ref() != TypeRef::int32) {
+            error_vector.emplace_back(ErrorType::semantical, main->get_line(), main->get_column(), 
                 "Method 'main' should return with type 'int32'");
         }
     }
 
     // Check dynamic types corresponds to static types and checks function/variable used have been defined
-    expAST = check_typecast(expAST);
+    check_methods();
+    Scope local_var;
+    check_typecast(expAST, local_var);
 
     return error_vector.empty() ? 0 : -1;
 }
@@ -90,66 +143,70 @@ void Checker::build() {
     for(auto &clazz : s->get_defined_clazzes()) {
 
         // Get class scope and add to class definition
-        std::string scope = clazz.get_data(DataType::id);
-
-        for(auto &field : clazz.get_children(NodeType::field)) {
-            Node ret = s->add_field_to_clazz(scope, field);
-            if(!ret.is_empty()) { // If field is redefined within clazz
-                error_vector.emplace_back(ErrorType::semantical, clazz.get_line(), clazz.get_column(), 
-                    field.get_data(DataType::id) + " has already be defined at " + std::to_string(ret.get_line()) + 
-                    ":" + std::to_string(ret.get_column()));
+        std::string scope = clazz->get_data(DataType::id);
+
+        for(auto &field : clazz->get_children(NodeType::field)) {
+            const Node *ret = s->add_field_to_clazz(scope, field);
+            if(ret != nullptr) { // If field is redefined within clazz
+                error_vector.emplace_back(ErrorType::semantical, clazz->get_line(), clazz->get_column(), 
+                    field.get_data(DataType::id) + " has already be defined at " + std::to_string(ret->get_line()) + 
+                    ":" + std::to_string(ret->get_column()));
             } 
         }
 
-        for(auto &method : clazz.get_children(NodeType::method)) {
-            Node ret = s->add_method_to_clazz(scope, method);
-            if(!ret.is_empty()) { // If method is redefined within clazz
-                error_vector.emplace_back(ErrorType::semantical, clazz.get_line(), clazz.get_column(), 
-                    method.get_data(DataType::id) + " has already be defined at " + std::to_string(ret.get_line()) + 
-                    ":" + std::to_string(ret.get_column()));
+        for(auto &method : clazz->get_children(NodeType::method)) {
+            const Node *ret = s->add_method_to_clazz(scope, method);
+            if(ret != nullptr) { // If method is redefined within clazz
+                error_vector.emplace_back(ErrorType::semantical, clazz->get_line(), clazz->get_column(), 
+                    method.get_data(DataType::id) + " has already be defined at " + std::to_string(ret->get_line()) + 
+                    ":" + std::to_string(ret->get_column()));
             }
         }
     }
 
+    // Flatten the inherited fields and methods of each clazz
+    s->build_layouts();
+
     // check inherited methods and fields redefinition
     for(auto &clazz : s->get_defined_clazzes()) {
-        std::string parent = clazz.get_data(DataType::parent_id);
+        std::string parent = clazz->get_data(DataType::parent_id);
 
-        for(auto &field : clazz.get_children(NodeType::field)) {
-            Node ret = s->find_field(parent, field.get_data(DataType::id));
-            if(!ret.is_empty()) {
+        for(auto &field : clazz->get_children(NodeType::field)) {
+            const Node *ret = s->find_field(parent, field.get_data(DataType::id));
+            if(ret != nullptr) {
                 error_vector.emplace_back(ErrorType::semantical, field.get_line(), field.get_column(), 
-                    field.get_data(DataType::id) + " cannot be redefined, defined first at " + std::to_string(ret.get_line()) + 
-                    ":" + std::to_string(ret.get_column()));
+                    field.get_data(DataType::id) + " cannot be redefined, defined first at " + std::to_string(ret->get_line()) + 
+                    ":" + std::to_string(ret->get_column()));
             }
         }
 
-        for(auto &method : clazz.get_children(NodeType::method)) {
-            Node ret = s->find_method(parent, method.get_data(DataType::id));
-            if(!ret.is_empty()) {
+        for(auto &method : clazz->get_children(NodeType::method)) {
+            const Node *ret = s->find_method(parent, method.get_data(DataType::id));
+            if(ret != nullptr) {
         
-                if(ret.get_data(DataType::type).compare(method.get_data(DataType::type)) != 0) {
+                if(ret->get_data(DataType::type).compare(method.get_data(DataType::type)) != 0) {
                     // check if return type is the same
                     error_vector.emplace_back(ErrorType::semantical, method.get_line(), method.get_column(), 
-                        method.get_data(DataType::id) + " cannot be redefined, defined first at " + std::to_string(ret.get_line()) + 
-                        ":" + std::to_string(ret.get_column()));
+                        method.get_data(DataType::id) + " cannot be redefined, defined first at " + std::to_string(ret->get_line()) + 
+                        ":" + std::to_string(ret->get_column()));
 
                 } else {
                     // check if formals are the same
-                    if(ret.get_children(NodeType::formal).size() != method.get_children(NodeType::formal).size()) {
+                    const std::vector<Node> &ret_formals = ret->get_children(NodeType::formal);
+                    const std::vector<Node> &formals = method.get_children(NodeType::formal);
+
+                    if(ret_formals.size() != formals.size()) {
                         error_vector.emplace_back(ErrorType::semantical, method.get_line(), method.get_column(), 
-                            method.get_data(DataType::id) + " cannot be redefined, defined first at " + std::to_string(ret.get_line()) + 
-                            ":" + std::to_string(ret.get_column()));
+                            method.get_data(DataType::id) + " cannot be redefined, defined first at " + std::to_string(ret->get_line()) + 
+                            ":" + std::to_string(ret->get_column()));
                     } else {
-                        for(size_t i = 0; i < ret.get_children(NodeType::formal).size(); ++i) {
-                            if(!(ret.get_children(NodeType::formal)[i].get_data(DataType::id).compare(
-                                method.get_children(NodeType::formal)[i].get_data(DataType::id)) == 0 &&
-                                ret.get_children(NodeType::formal)[i].get_data(DataType::type).compare(
-                                method.get_children(NodeType::formal)[i].get_data(DataType::type)) == 0)) {
+                        for(size_t i = 0; i < ret_formals.size(); ++i) {
+                            if(!(ret_formals[i].get_data(DataType::id).compare(formals[i].get_data(DataType::id)) == 0 &&
+                                ret_formals[i].get_data(DataType::type).compare(formals[i].get_data(DataType::type)) == 0)) {
 
                                     error_vector.emplace_back(ErrorType::semantical, method.get_line(), method.get_column(), 
-                                        method.get_data(DataType::id) + " cannot be redefined, defined first at " + std::to_string(ret.get_line()) + 
-                                        ":" + std::to_string(ret.get_column()));
+                                        method.get_data(DataType::id) + " cannot be redefined, defined first at " + std::to_string(ret->get_line()) + 
+                                        ":" + std::to_string(ret->get_column()));
                                 }
                         }
                     }
@@ -157,250 +214,433 @@ void Checker::build() {
             }
         }
     }
+
+    // Check the declared types, so that the declarations are read-only while checking the bodies
+    for(auto &clazz : expAST.get_children(NodeType::clazz)) {
+        for(auto &field : clazz.get_children(NodeType::field)) {
+            TypeRef type = s->get_type_ref(field.get_data(DataType::type));
+
+            if(type.is_none()) {
+                error_vector.emplace_back(ErrorType::semantical, field.get_line(), field.get_column(), 
+                    field.get_data(DataType::type) + " is undefined");
+                type = TypeRef::unit;
+            }
+            annotate(field, type);
+        }
+
+        for(auto &method : clazz.get_children(NodeType::method)) {
+            TypeRef type = s->get_type_ref(method.get_data(DataType::type));
+
+            if(type.is_none()) {
+                error_vector.emplace_back(ErrorType::semantical, method.get_line(), method.get_column(), 
+                    method.get_data(DataType::type) + " is undefined");
+                type = TypeRef::unit;
+            }
+            annotate(method, type);
+
+            // An undefined formal is kept as declared (none) and left unbound in the body
+            for(auto &formal : method.get_children(NodeType::formal)) {
+                type = s->get_type_ref(formal.get_data(DataType::type));
+
+                if(type.is_none()) {
+                    error_vector.emplace_back(ErrorType::semantical, formal.get_line(), formal.get_column(), 
+                        formal.get_data(DataType::type) + " is undefined");
+                }
+                formal.set_type_ref(type);
+            }
+        }
+    }
+
+    // No clazz or member is added from now on
+    s->freeze();
+}
+
+void Checker::check_methods() {
+    renumbered = (previous != nullptr && previous->type_names != type_names);
+
+    // Only check the methods that cannot be reused
+    std::vector<size_t> tasks;
+    for(size_t i = 0; i < methods.size(); ++i) {
+        if(!reuse_method(i)) {
+            tasks.push_back(i);
+        }
+    }
+    next_checked = 0;
+
+    // Each worker takes the next unchecked method until none is left
+    std::atomic<size_t> next_task(0);
+    auto worker = [&]() {
+        size_t t;
+        while((t = next_task++) < tasks.size()) {
+            size_t i = tasks[t];
+            Checker method_checker(Node(), 1, incremental); // Own error vector and dependencies
+            Scope local_var;
+            method_checker.check_typecast(*methods[i].second, local_var, methods[i].first, false);
+
+            // The errors are kept relative to the method, which may move in a later check
+            records[i].errors = std::move(method_checker.error_vector);
+            for(auto &error : records[i].errors) {
+                error.shift_lines(-methods[i].second->get_line());
+            }
+            records[i].resolved = std::move(method_checker.resolved);
+            for(auto &dependency : method_checker.dependencies) {
+                records[i].dependencies.emplace_back(dependency, std::string());
+            }
+        }
+    };
+
+    if(jobs <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        for(size_t t = 0; t < (size_t) jobs && t < tasks.size(); ++t) {
+            pool.emplace_back(worker);
+        }
+        for(auto &thread : pool) {
+            thread.join();
+        }
+    }
+
+    // Resolve the dependencies once the SymbolTable is no longer shared
+    for(auto i : tasks) {
+        for(auto &dependency : records[i].dependencies) {
+            dependency.second = dependency_value(dependency.first);
+        }
+    }
+}
+
+bool Checker::reuse_method(size_t i) {
+    SymbolTable *s = SymbolTable::getInstance();
+
+    if(previous == nullptr) {
+        return false;
+    }
+
+    auto index = previous->record_index.find(methods[i].first + "." + methods[i].second->get_data(DataType::id));
+    if(index == previous->record_index.end()) {
+        return false;
+    }
+
+    // The method must be unchanged, and everything it relied on must resolve the same way
+    MethodRecord &record = previous->records[index->second];
+    if(record.hash != records[i].hash) {
+        return false;
+    }
+    for(auto &dependency : record.dependencies) {
+        if(renumbered && dependency.first.clazz.is_clazz()) {
+            // The clazz numbers of previous, translated in place as the record is taken or dropped
+            TypeRef clazz = s->get_type_ref(previous->type_names[dependency.first.clazz.get_clazz()]);
+            if(clazz.is_none()) {
+                return false;
+            }
+            dependency.first.clazz = clazz;
+        }
+        if(dependency_value(dependency.first) != dependency.second) {
+            return false;
+        }
+    }
+
+    // Take the annotated body, each record is taken once
+    Node &method = *previous->methods[index->second].second;
+    Node &block = methods[i].second->get_children(NodeType::block).front();
+    std::swap(method.get_children(NodeType::block), methods[i].second->get_children(NodeType::block));
+    previous->record_index.erase(index);
+
+    // Move the body along with the method
+    if(method.get_line() != methods[i].second->get_line()) {
+        block.shift_lines(methods[i].second->get_line() - method.get_line());
+    }
+
+    if(renumbered) {
+        renumber(block);
+    }
+
+    // The declarations belong to the AST of previous
+    for(auto node : record.resolved) {
+        if(node->get_type() == NodeType::call_expr) {
+            node->set_decl(s->find_method(node->get_children(NodeType::parent_statement).front().get_type_ref(), node->get_data(DataType::id)));
+        } else if(node->get_type() == NodeType::assign_expr) {
+            node->set_decl(s->find_field(methods[i].first, node->get_data(DataType::id)));
+        } else {
+            node->set_decl(s->find_field(methods[i].first, node->get_data(DataType::literal_value)));
+        }
+    }
+
+    records[i].dependencies = std::move(record.dependencies);
+    records[i].errors = std::move(record.errors);
+    records[i].resolved = std::move(record.resolved);
+    ++reused;
+    return true;
+}
+
+void Checker::renumber(Node &n) {
+    if(StackSegment::is_exhausted()) {
+        StackSegment::grow([&]() {
+            renumber(n);
+        });
+        return;
+    }
+
+    if(n.get_type_ref().is_clazz()) {
+        n.set_type_ref(SymbolTable::getInstance()->get_type_ref(previous->type_names[n.get_type_ref().get_clazz()]));
+    }
+
+    for(auto &type : n.get_children_types()) {
+        for(auto &child : n.get_children(type)) {
+            renumber(child);
+        }
+    }
+}
+
+void Checker::depend(DependencyKind kind, const std::string &clazz, const std::string &id) {
+    if(!incremental) {
+        return;
+    }
+
+    TypeRef type = SymbolTable::getInstance()->get_type_ref(clazz);
+    if(kind == DependencyKind::clazz && type.is_none()) {
+        // Undefined for now, recorded by name
+        dependencies.insert(Dependency{kind, type, clazz});
+        return;
+    }
+    depend(kind, type, id);
+}
+
+void Checker::depend(DependencyKind kind, TypeRef clazz, const std::string &id) {
+    if(!incremental || (kind == DependencyKind::clazz && !clazz.is_clazz())) {
+        return;
+    }
+    dependencies.insert(Dependency{kind, clazz, id});
+}
+
+const std::string &Checker::dependency_value(const Dependency &dependency) {
+    SymbolTable *s = SymbolTable::getInstance();
+
+    auto cached = values.find(dependency);
+    if(cached != values.end()) {
+        return cached->second;
+    }
+
+    std::string value;
+    std::string clazz = s->get_type_name(dependency.clazz);
+    if(dependency.kind == DependencyKind::clazz && dependency.clazz.is_none()) {
+        clazz = dependency.id;
+    }
+
+    if(dependency.kind == DependencyKind::clazz) {
+        // Its place in the hierarchy, which decides every subtyping check
+        if(!s->get_type_ref(clazz).is_none()) {
+            for(auto &ancestor : s->get_all_ancestors(clazz)) {
+                value += " " + ancestor;
+            }
+        }
+    } else if(dependency.kind == DependencyKind::field) {
+        const Node *field = s->find_field(clazz, dependency.id);
+        if(field != nullptr) {
+            value = field->get_data(DataType::type) + " " + std::to_string(s->get_field_slot(clazz, dependency.id));
+        }
+    } else {
+        const Node *method = s->find_method(dependency.clazz, dependency.id);
+        if(method != nullptr) {
+            value = method->get_data(DataType::type) + " " + std::to_string(s->get_method_slot(dependency.clazz, dependency.id));
+            for(auto &formal : method->get_children(NodeType::formal)) {
+                value += " " + formal.get_data(DataType::type);
+            }
+        }
+    }
+    return values[dependency] = value;
+}
+
+TypeRef Checker::annotate(Node &n, TypeRef t) {
+    std::string name = SymbolTable::getInstance()->get_type_name(t);
+    n.set_return_type(name);
+    n.set_type_ref(t);
+    return t;
 }
 
-Node Checker::check_typecast(Node &n, std::map<std::string, std::string> local_var, std::string cur_clazz, bool inst) {
-    std::string ret_type, d_type, d_type2;
-    Node node, expr, expr2;
-    std::vector<Node> vec_node = std::vector<Node>();
+TypeRef Checker::check_typecast(Node &n, Scope &local_var, const std::string &cur_clazz, bool inst) {
+    TypeRef ret_type, d_type, d_type2;
+    size_t mark = local_var.size();
+    Node *expr, *expr2;
+    const Node *decl;
+    static const Node undefined = Node(); // The declaration of an undefined method
     SymbolTable *s = SymbolTable::getInstance();
 
+    // Go on with a new stack segment when the AST is too deep for this one
+    if(StackSegment::is_exhausted()) {
+        StackSegment::grow([&]() {
+            ret_type = check_typecast(n, local_var, cur_clazz, inst);
+        });
+        return ret_type;
+    }
+
     switch (n.get_type()) {
         case NodeType::program:
             for(auto &clazz : n.get_children(NodeType::clazz)) {
-                cur_clazz = clazz.get_data(DataType::id);
-                node = check_typecast(clazz, local_var, cur_clazz, inst);
-
-                vec_node.push_back(node);
+                check_typecast(clazz, local_var, clazz.get_data(DataType::id), inst);
             }
-            n.set_children(NodeType::clazz, vec_node);
-
-            ret_type = std::string("int32");
-            n.set_return_type(ret_type);
-            return n;
+            return annotate(n, TypeRef::int32);
 
         case NodeType::clazz:
             for(auto &field : n.get_children(NodeType::field)) {
-                node = check_typecast(field, local_var, cur_clazz, true);
-                vec_node.push_back(node);
+                check_typecast(field, local_var, cur_clazz, true);
             }
-            n.set_children(NodeType::field, vec_node);
-            vec_node.clear();
 
+            // Already checked (or reused) by check_methods
             for(auto &method : n.get_children(NodeType::method)) {
-                node = check_typecast(method, local_var, cur_clazz, false);
-                vec_node.push_back(node);
+                for(auto error : records[next_checked++].errors) {
+                    error.shift_lines(method.get_line());
+                    error_vector.push_back(error);
+                }
             }
-            n.set_children(NodeType::method, vec_node);
-
-            ret_type = n.get_data(DataType::id);
-            n.set_return_type(ret_type);
-            s->update_clazz(n);
-            return n;
+            n.set_decl(s->get_clazz(n.get_data(DataType::parent_id)));
+            return annotate(n, s->get_type_ref(n.get_data(DataType::id)));
 
         case NodeType::field:
-            ret_type = n.get_data(DataType::type);
-
-            // check user input type is legit
-            if(ret_type.compare("int32") != 0 && ret_type.compare("string") != 0 && ret_type.compare("unit") != 0 &&
-                ret_type.compare("bool") != 0 && !s->is_defined_clazz(ret_type)) {
-                    error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
-                        ret_type + " is undefined");
-
-                    ret_type = std::string("unit");
-            }
+            // Declared type, checked by build
+            ret_type = n.get_type_ref();
 
             // Check if initialization block return type matches the expected type 
             if(!n.get_children(NodeType::any_expr).empty()) {
-                expr = *n.get_children(NodeType::any_expr).begin();
-                node = check_typecast(expr, local_var, cur_clazz, true);
-                n.set_children(NodeType::any_expr, {node});
-                d_type = node.get_data(DataType::type);
-
-                if(d_type.compare(ret_type) != 0 && !s->is_parent_of_child(ret_type, d_type)) {
-                    error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
-                        "Field is type " + ret_type + " but initializer is type " + d_type);
+                expr = &n.get_children(NodeType::any_expr).front();
+                d_type = check_typecast(*expr, local_var, cur_clazz, true);
+
+                if(d_type != ret_type && !s->is_parent_of_child(ret_type, d_type)) {
+                    error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                        "Field is type " + s->get_type_name(ret_type) + " but initializer is type " + s->get_type_name(d_type));
                 }
             } 
-            
-            n.set_return_type(ret_type);
-            s->update_field(cur_clazz, n);
-            return n;
+            return ret_type;
 
         case NodeType::method:
-            ret_type = n.get_data(DataType::type);
-
-            // check if user input type is legit
-            if(ret_type.compare("int32") != 0 && ret_type.compare("string") != 0 && ret_type.compare("unit") != 0 &&
-                ret_type.compare("bool") != 0 && !s->is_defined_clazz(ret_type)) {
-                    error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
-                        ret_type + " is undefined");
-
-                    ret_type = std::string("unit");
-            }
-
-            expr = *n.get_children(NodeType::block).begin();
-
-            // Check if formals have correct type and are not redefined
-            for(auto &formal : n.get_children(NodeType::formal)) {
-                auto form = local_var[formal.get_data(DataType::id)];
-
-                if(!form.empty()) {
+            // Declared type, checked by build (the method node is only read, other threads may look it up)
+            ret_type = n.get_type_ref();
+            depend(DependencyKind::clazz, n.get_data(DataType::type));
+
+            // Check if formals are not redefined, and bind the defined ones
+            for(auto &formal : static_cast<const Node &>(n).get_children(NodeType::formal)) {
+                depend(DependencyKind::clazz, formal.get_data(DataType::type));
+                if(!local_var.lookup(formal.get_symbol()).is_none()) {
                     error_vector.emplace_back(ErrorType::semantical, formal.get_line(), formal.get_column(), 
                         formal.get_data(DataType::id) + " has already been defined.");
-                } else {
-                    auto type = formal.get_data(DataType::type);
-
-                    if(type.compare("int32") != 0 && type.compare("string") != 0 && type.compare("unit") != 0 &&
-                        type.compare("bool") != 0 && !s->is_defined_clazz(type)) {
-                            error_vector.emplace_back(ErrorType::semantical, formal.get_line(), formal.get_column(), 
-                                ret_type + " is undefined");
-                    } else {
-                        local_var[formal.get_data(DataType::id)] = formal.get_data(DataType::type);
-                    }
+                } else if(!formal.get_type_ref().is_none()) {
+                    local_var.push(formal.get_symbol(), formal.get_type_ref());
                 }
             }
 
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::block, {node});
-            d_type = node.get_data(DataType::type);
+            expr = &n.get_children(NodeType::block).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz, inst);
+            local_var.unwind(mark); // Formals go out of scope
 
-            if(d_type.compare(ret_type) != 0 && !s->is_parent_of_child(ret_type, d_type)) {
-                error_vector.emplace_back(ErrorType::semantical, expr.get_children(NodeType::any_expr).back().get_line(), 
-                expr.get_children(NodeType::any_expr).back().get_column(), "Method is type " + ret_type + " but block is type " + d_type);
+            if(d_type != ret_type && !s->is_parent_of_child(ret_type, d_type)) {
+                error_vector.emplace_back(ErrorType::semantical, expr->get_children(NodeType::any_expr).back().get_line(), 
+                expr->get_children(NodeType::any_expr).back().get_column(), "Method is type " + s->get_type_name(ret_type) + 
+                " but block is type " + s->get_type_name(d_type));
             }
-            n.set_return_type(ret_type);
-            s->update_method(cur_clazz, n);
-            return n;
+            return ret_type;
             
         case NodeType::block:
 
             for(auto &e : n.get_children(NodeType::any_expr)) {
-                node = check_typecast(e, local_var, cur_clazz, inst);
-                vec_node.push_back(node);
+                d_type = check_typecast(e, local_var, cur_clazz, inst);
             }
-            n.set_children(NodeType::any_expr, vec_node);
-            d_type = n.get_children(NodeType::any_expr).back().get_data(DataType::type);
-            n.set_return_type(d_type);
-            return n;
+            return annotate(n, d_type);
 
         case NodeType::if_expr:
-            expr = *n.get_children(NodeType::if_statement).begin();
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::if_statement, {node});
-            d_type = node.get_data(DataType::type);
+            expr = &n.get_children(NodeType::if_statement).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz, inst);
 
-            if(d_type.compare("bool") != 0) {
-                error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
-                    "Condition is type " + d_type + " but should be type bool");
+            if(d_type != TypeRef::boolean) {
+                error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                    "Condition is type " + s->get_type_name(d_type) + " but should be type bool");
             }
-            expr = *n.get_children(NodeType::then_statement).begin();
-            node = check_typecast(expr, local_var, cur_clazz,inst);
-            n.set_children(NodeType::then_statement, {node});
-            d_type = node.get_data(DataType::type);
+            expr = &n.get_children(NodeType::then_statement).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz,inst);
 
+            expr2 = nullptr;
             if(!n.get_children(NodeType::else_statement).empty()) {
-                expr2 = *n.get_children(NodeType::else_statement).begin();
-                node = check_typecast(expr2, local_var, cur_clazz, inst);
-                n.set_children(NodeType::else_statement, {node});
-                d_type2 = node.get_data(DataType::type);
+                expr2 = &n.get_children(NodeType::else_statement).front();
+                d_type2 = check_typecast(*expr2, local_var, cur_clazz, inst);
             } else {
-                d_type2 = std::string("unit");
+                d_type2 = TypeRef::unit;
             }
 
-            if(s->is_defined_clazz(d_type) && s->is_defined_clazz(d_type2)) {
+            if(d_type.is_clazz() && d_type2.is_clazz()) {
                 // Both branches are of type class 
 
-                    auto ancestor = s->find_common_ancestor(d_type, d_type2);
-                    if(ancestor.empty()) {
-                        error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
+                    ret_type = s->find_common_ancestor(d_type, d_type2);
+                    if(ret_type.is_none()) {
+                        error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
                             "Expressions do not possess a common ancestor.");
-                        d_type = std::string("unit");
-
-                    } else {
-                        d_type = ancestor;
+                        ret_type = TypeRef::unit;
                     }
-                    n.set_return_type(d_type);
-                    return n;
+                    return annotate(n, ret_type);
             } 
             
             // One of the two branch is unit
-            if(d_type.compare("unit") == 0 or d_type2.compare("unit") == 0) {
-                std::string type = std::string("unit");
-                n.set_return_type(type);
-                return n;
+            if(d_type == TypeRef::unit or d_type2 == TypeRef::unit) {
+                return annotate(n, TypeRef::unit);
             }
             
             // The types don't match
-            if(d_type.compare(d_type2) != 0) { 
-                error_vector.emplace_back(ErrorType::semantical, expr2.get_line(), expr2.get_column(), 
-                    "Expressions should return the same type but one returns " + d_type + "and the other " + d_type2);
+            if(d_type != d_type2) { 
+                error_vector.emplace_back(ErrorType::semantical, expr2->get_line(), expr2->get_column(), 
+                    "Expressions should return the same type but one returns " + s->get_type_name(d_type) + 
+                    "and the other " + s->get_type_name(d_type2));
             }
-            n.set_return_type(d_type);
-
-            return n;
+            return annotate(n, d_type);
 
         case NodeType::while_expr:
-            expr = *n.get_children(NodeType::while_statement).begin();
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::while_statement, {node});
-            d_type = node.get_data(DataType::type);
+            expr = &n.get_children(NodeType::while_statement).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz, inst);
 
-            if(d_type.compare("bool") != 0) {
-                error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
-                    "Condition is type '" + d_type + "' but should be type bool");
+            if(d_type != TypeRef::boolean) {
+                error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                    "Condition is type '" + s->get_type_name(d_type) + "' but should be type bool");
             }
 
-            expr = *n.get_children(NodeType::do_statement).begin();
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::do_statement, {node});
+            expr = &n.get_children(NodeType::do_statement).front();
+            check_typecast(*expr, local_var, cur_clazz, inst);
 
-            ret_type = std::string("unit");
-            n.set_return_type(ret_type);
-            return n;
+            return annotate(n, TypeRef::unit);
 
         case NodeType::let_expr:
-            expr = *n.get_children(NodeType::object_identifier).begin();
-            if(expr.get_data(DataType::literal_value).compare("self") == 0) {
-                error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
+            expr = &n.get_children(NodeType::object_identifier).front();
+            if(expr->get_data(DataType::literal_value).compare("self") == 0) {
+                error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
                     "Self cannot be bound identifier.");
             }
             
-            expr = *n.get_children(NodeType::object_identifier).begin();
-            ret_type = expr.get_data(DataType::type);
-
             // Check if user input type is legit
-            if(ret_type.compare("int32") != 0 && ret_type.compare("string") != 0 && ret_type.compare("unit") != 0 &&
-                ret_type.compare("bool") != 0 && !s->is_defined_clazz(ret_type)) {
-                    error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
-                        ret_type + "is undefined");
+            depend(DependencyKind::clazz, expr->get_data(DataType::type));
+            ret_type = s->get_type_ref(expr->get_data(DataType::type));
+            if(ret_type.is_none()) {
+                error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                    expr->get_data(DataType::type) + "is undefined");
 
-                    ret_type = std::string("unit");
+                ret_type = TypeRef::unit;
             }
+            expr->set_type_ref(ret_type); // The declared string is kept for display
 
             // Check if the initilize statement type matches the expected one
             if(!n.get_children(NodeType::init_statement).empty()) {
-                expr2 = *n.get_children(NodeType::init_statement).begin();
-                node = check_typecast(expr2, local_var, cur_clazz, inst);
-                n.set_children(NodeType::init_statement, {node});
-                d_type = node.get_data(DataType::type);
-
-                if(d_type.compare(ret_type) != 0 && !s->is_parent_of_child(ret_type, d_type)) {
-                    error_vector.emplace_back(ErrorType::semantical, expr2.get_line(), expr2.get_column(), 
-                        "Initializer is type " + d_type + " but should be type " + ret_type);
+                expr2 = &n.get_children(NodeType::init_statement).front();
+                d_type = check_typecast(*expr2, local_var, cur_clazz, inst);
+
+                if(d_type != ret_type && !s->is_parent_of_child(ret_type, d_type)) {
+                    error_vector.emplace_back(ErrorType::semantical, expr2->get_line(), expr2->get_column(), 
+                        "Initializer is type " + s->get_type_name(d_type) + " but should be type " + s->get_type_name(ret_type));
                 }
             } 
 
-            // Add to the local variable map
-            local_var[expr.get_data(DataType::literal_value)] = ret_type;
+            // Bind the variable for the scope statement only
+            local_var.push(expr->get_symbol(), ret_type);
 
-            expr = *n.get_children(NodeType::scope_statement).begin();
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::scope_statement, {node});
-            d_type = node.get_data(DataType::type);
+            expr = &n.get_children(NodeType::scope_statement).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz, inst);
+            local_var.pop();
 
-            n.set_return_type(d_type);
-            return n;
+            return annotate(n, d_type);
 
         case NodeType::assign_expr:
             // Check for self assign
@@ -410,175 +650,174 @@ Node Checker::check_typecast(Node &n, std::map<std::string, std::string> local_v
             }
 
             // Get the object identifier expected type from local variable table
-            ret_type = local_var[n.get_data(DataType::id)];
-            if(ret_type.empty()) {
+            ret_type = local_var.lookup(n.get_symbol());
+            if(ret_type.is_none()) {
 
                 // If none found, check in local and inhereted fields
-                node = s->find_field(cur_clazz, n.get_data(DataType::id));
-                if(!node.is_empty() && !node.get_data(DataType::type).empty()) {
-                    ret_type = node.get_data(DataType::type);
+                depend(DependencyKind::field, cur_clazz, n.get_data(DataType::id));
+                decl = s->find_field(cur_clazz, n.get_data(DataType::id));
+                if(decl != nullptr && !decl->get_type_ref().is_none()) {
+                    depend(DependencyKind::clazz, decl->get_type_ref());
+                    ret_type = decl->get_type_ref();
+                    n.set_decl(decl);
+                    n.set_slot(s->get_field_slot(cur_clazz, n.get_data(DataType::id)));
+                    if(incremental) {
+                        resolved.push_back(&n);
+                    }
                 } else {
                     // If none found, error
                     error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
                         n.get_data(DataType::id) + "has not been defined");
-                    ret_type = std::string("unit");
+                    ret_type = TypeRef::unit;
                 }
             }
-            expr = *n.get_children(NodeType::any_expr).begin();
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::any_expr, {node});
-            d_type = node.get_data(DataType::type);
+            expr = &n.get_children(NodeType::any_expr).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz, inst);
 
-            if(d_type.compare(ret_type) != 0 && !s->is_parent_of_child(ret_type, d_type)) {
-                error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
-                    "Expression should be of type " + ret_type + " but is of type " + d_type);
+            if(d_type != ret_type && !s->is_parent_of_child(ret_type, d_type)) {
+                error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                    "Expression should be of type " + s->get_type_name(ret_type) + " but is of type " + s->get_type_name(d_type));
             }
-            n.set_return_type(ret_type);
-            return n;
+            return annotate(n, ret_type);
 
         case NodeType::unop_expr:
-            expr = *n.get_children(NodeType::any_expr).begin();
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::any_expr, {node});
-            d_type = node.get_data(DataType::type);
+            expr = &n.get_children(NodeType::any_expr).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz, inst);
 
             if(n.get_data(DataType::op).compare("-") == 0) {
-                if(d_type.compare("int32") != 0) {
-                    error_vector.emplace_back(ErrorType::semantical, node.get_line(), node.get_column(), 
-                        "Expression should be of type int32 but is of type " + d_type);
+                if(d_type != TypeRef::int32) {
+                    error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                        "Expression should be of type int32 but is of type " + s->get_type_name(d_type));
                 }
-                ret_type = std::string("int32");
+                ret_type = TypeRef::int32;
 
             } else if(n.get_data(DataType::op).compare("isnull") == 0) {
-                if(!s->is_defined_clazz(d_type)) { // Check if class 
+                if(!d_type.is_clazz()) { // Check if class 
 
-                    error_vector.emplace_back(ErrorType::semantical, node.get_line(), node.get_column(), 
-                        "Expression should be an class identifier but is of type " + d_type);
+                    error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                        "Expression should be an class identifier but is of type " + s->get_type_name(d_type));
                 }
-                ret_type = std::string("bool");
+                ret_type = TypeRef::boolean;
 
             } else {
-                if(d_type.compare("bool") != 0) {
-                    error_vector.emplace_back(ErrorType::semantical, node.get_line(), node.get_column(), 
-                        "Expression should be of type bool but is of type " + d_type);
+                if(d_type != TypeRef::boolean) {
+                    error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                        "Expression should be of type bool but is of type " + s->get_type_name(d_type));
                 }
-                ret_type = std::string("bool");
+                ret_type = TypeRef::boolean;
             }
-            n.set_return_type(ret_type);
-            return n;
+            return annotate(n, ret_type);
 
         case NodeType::binop_expr:
-            expr = *n.get_children(NodeType::left_statement).begin();
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::left_statement, {node});
-            d_type = node.get_data(DataType::type);
+            expr = &n.get_children(NodeType::left_statement).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz, inst);
 
-            expr2 = *n.get_children(NodeType::right_statement).begin();
-            node = check_typecast(expr2, local_var, cur_clazz, inst);
-            n.set_children(NodeType::right_statement, {node});
-            d_type2 = node.get_data(DataType::type);
+            expr2 = &n.get_children(NodeType::right_statement).front();
+            d_type2 = check_typecast(*expr2, local_var, cur_clazz, inst);
 
             if(n.get_data(DataType::op).compare("=") == 0) {
-                if(d_type.compare(d_type2) != 0 && !s->is_parent_of_child(d_type, d_type2) &&
-                    !s->is_parent_of_child(d_type2, d_type)) {
+                if(d_type != d_type2 && !s->is_parent_of_child(d_type, d_type2) && !s->is_parent_of_child(d_type2, d_type)) {
                     error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
-                        "Expression should have the same type but one is " + d_type + " and the other " + d_type2);
+                        "Expression should have the same type but one is " + s->get_type_name(d_type) + 
+                        " and the other " + s->get_type_name(d_type2));
                 }
-                ret_type = std::string("bool");
-                n.set_return_type(ret_type);
-                return n;
+                return annotate(n, TypeRef::boolean);
             }
 
             if(n.get_data(DataType::op).compare("and") == 0) {
-                if(d_type.compare("bool") != 0) {
-                    error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
-                        "Expression should be of type bool but is of type " + d_type);
+                if(d_type != TypeRef::boolean) {
+                    error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                        "Expression should be of type bool but is of type " + s->get_type_name(d_type));
                 }
-                if(d_type2.compare("bool") != 0) {
-                    error_vector.emplace_back(ErrorType::semantical, expr2.get_line(), expr2.get_column(), 
-                        "Expression should be of type bool but is of type " + d_type2);
+                if(d_type2 != TypeRef::boolean) {
+                    error_vector.emplace_back(ErrorType::semantical, expr2->get_line(), expr2->get_column(), 
+                        "Expression should be of type bool but is of type " + s->get_type_name(d_type2));
                 }
-                ret_type = std::string("bool");
-                n.set_return_type(ret_type);
-                return n;
+                return annotate(n, TypeRef::boolean);
             }
 
-            if(d_type.compare("int32") != 0) {
-                error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
-                    "Expression should be of type int32 but is of type " + d_type);
+            if(d_type != TypeRef::int32) {
+                error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                    "Expression should be of type int32 but is of type " + s->get_type_name(d_type));
             }
 
-            if(d_type2.compare("int32") != 0) {
-                error_vector.emplace_back(ErrorType::semantical, expr2.get_line(), expr2.get_column(), 
-                    "Expression should be of type int32 but is of type " + d_type2);
+            if(d_type2 != TypeRef::int32) {
+                error_vector.emplace_back(ErrorType::semantical, expr2->get_line(), expr2->get_column(), 
+                    "Expression should be of type int32 but is of type " + s->get_type_name(d_type2));
             }
 
-            ret_type = std::string("int32");
+            ret_type = TypeRef::int32;
 
             if(n.get_data(DataType::op).compare("<") == 0 || n.get_data(DataType::op).compare("<=") == 0) {
-                ret_type = std::string("bool");
+                ret_type = TypeRef::boolean;
             }
-            n.set_return_type(ret_type);
-            return n;
+            return annotate(n, ret_type);
 
         case NodeType::call_expr:
-            expr = *n.get_children(NodeType::parent_statement).begin();
-            node = check_typecast(expr, local_var, cur_clazz, inst);
-            n.set_children(NodeType::parent_statement, {node});
+            expr = &n.get_children(NodeType::parent_statement).front();
+            d_type = check_typecast(*expr, local_var, cur_clazz, inst);
 
             // Check the method has been defined in scope
-            node = s->find_method(node.get_data(DataType::type), n.get_data(DataType::id));
-            d_type = node.get_data(DataType::type);
+            depend(DependencyKind::method, d_type, n.get_data(DataType::id));
+            decl = s->find_method(d_type, n.get_data(DataType::id));
+            n.set_decl(decl);
+            if(decl != nullptr) {
+                if(incremental) {
+                    resolved.push_back(&n);
+                }
+            }
+            n.set_slot(s->get_method_slot(d_type, n.get_data(DataType::id)));
+            ret_type = (decl == nullptr) ? TypeRef() : decl->get_type_ref();
 
-            if(d_type.empty()) {
+            if(ret_type.is_none()) {
                 error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
                     n.get_data(DataType::id) + " has not been defined in scope");
-                d_type = std::string("unit");
+                ret_type = TypeRef::unit;
+                decl = &undefined; // No formal
             }
-            n.set_return_type(d_type);
+            depend(DependencyKind::clazz, ret_type);
+            for(auto &formal : decl->get_children(NodeType::formal)) {
+                depend(DependencyKind::clazz, formal.get_data(DataType::type));
+            }
+            annotate(n, ret_type);
 
             // Set args dynamic values
             for(auto &arg : n.get_children(NodeType::args)) {
-                expr = check_typecast(arg, local_var, cur_clazz, inst);
-                vec_node.push_back(expr);
+                check_typecast(arg, local_var, cur_clazz, inst);
             }
-            n.set_children(NodeType::args, vec_node);
 
             // Check args/formals equity
-            if(n.get_children(NodeType::args).size() != node.get_children(NodeType::formal).size()) {
+            if(n.get_children(NodeType::args).size() != decl->get_children(NodeType::formal).size()) {
+                expr = n.get_children(NodeType::args).empty() ? &n : &n.get_children(NodeType::args).front();
 
-                error_vector.emplace_back(ErrorType::semantical, n.get_children(NodeType::args).begin()->get_line(),
-                    n.get_children(NodeType::args).begin()->get_line(), "Argument mismatch: " + n.get_data(DataType::id) 
-                    + " requires " + std::to_string(node.get_children(NodeType::formal).size()) + " arguments but has " + 
+                error_vector.emplace_back(ErrorType::semantical, expr->get_line(),
+                    expr->get_column(), "Argument mismatch: " + n.get_data(DataType::id) 
+                    + " requires " + std::to_string(decl->get_children(NodeType::formal).size()) + " arguments but has " + 
                     std::to_string(n.get_children(NodeType::args).size()));
             
             } else {
                 for(size_t i = 0; i < n.get_children(NodeType::args).size(); ++i) {
-                    expr = vec_node[i];
-                    d_type = expr.get_data(DataType::type);
-
-                    expr2 = node.get_children(NodeType::formal)[i];
-                    ret_type = expr2.get_data(DataType::type);
+                    expr = &n.get_children(NodeType::args)[i];
+                    const Node &formal = decl->get_children(NodeType::formal)[i];
 
-                    if(d_type.compare(ret_type) != 0 && !s->is_parent_of_child(ret_type, d_type)) {
-                            error_vector.emplace_back(ErrorType::semantical, expr.get_line(), expr.get_column(), 
-                            "Argument should be " + ret_type + " but is of type " + d_type);
+                    if(expr->get_type_ref() != formal.get_type_ref() && !s->is_parent_of_child(formal.get_type_ref(), expr->get_type_ref())) {
+                            error_vector.emplace_back(ErrorType::semantical, expr->get_line(), expr->get_column(), 
+                            "Argument should be " + formal.get_data(DataType::type) + " but is of type " + s->get_type_name(expr->get_type_ref()));
                         }
                 }
             }
-            return n;
+            return ret_type;
 
         case NodeType::new_expr:
-            ret_type = n.get_data(DataType::id);
-            if(!s->is_defined_clazz(ret_type)) {
+            depend(DependencyKind::clazz, n.get_data(DataType::id));
+            ret_type = s->get_type_ref(n.get_data(DataType::id));
+            if(!ret_type.is_clazz()) {
                 error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
-                    ret_type + " is undefined");
+                    n.get_data(DataType::id) + " is undefined");
 
-                ret_type = std::string("unit");
+                ret_type = TypeRef::unit;
             }
-
-            n.set_return_type(ret_type);
-            return n;
+            return annotate(n, ret_type);
 
         case NodeType::object_identifier:
             if(inst && n.get_data(DataType::literal_value).compare("self") == 0) {
@@ -587,44 +826,50 @@ Node Checker::check_typecast(Node &n, std::map<std::string, std::string> local_v
             }
 
             // First check if object has a static type
-            ret_type = n.get_data(DataType::type);
-    
-            if(ret_type.empty()) {
+            if(n.get_data(DataType::type).empty()) {
                 // If none, look into the local variables
-                ret_type = local_var[n.get_data(DataType::literal_value)]; 
+                ret_type = local_var.lookup(n.get_symbol()); 
 
                 // If none and we are in clazz instantiation, the object identifier is not defined in scope.
-                if(inst && ret_type.empty()) {
+                if(inst && ret_type.is_none()) {
                     error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
                         "Reference to self element in instantiation is not allowed");
                 }
                 
-                if(ret_type.empty()) {
-                    node = s->find_field(cur_clazz, n.get_data(DataType::literal_value));
-                    if(!node.is_empty() && !node.get_data(DataType::type).empty()) {
-                        ret_type = node.get_data(DataType::type);
+                if(ret_type.is_none()) {
+                    depend(DependencyKind::field, cur_clazz, n.get_data(DataType::literal_value));
+                    decl = s->find_field(cur_clazz, n.get_data(DataType::literal_value));
+                    if(decl != nullptr && !decl->get_type_ref().is_none()) {
+                        depend(DependencyKind::clazz, decl->get_type_ref());
+                        ret_type = decl->get_type_ref();
+                        n.set_decl(decl);
+                        n.set_slot(s->get_field_slot(cur_clazz, n.get_data(DataType::literal_value)));
+                        if(incremental) {
+                            resolved.push_back(&n);
+                        }
 
                     } else {
                         error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
                             n.get_data(DataType::literal_value) + " has not been defined");
-                        ret_type = std::string("unit");
+                        ret_type = TypeRef::unit;
                     }
                 }
             } else {
-                if(ret_type.compare("int32") != 0 && ret_type.compare("string") != 0 && ret_type.compare("unit") != 0 &&
-                    ret_type.compare("bool") != 0 && !s->is_defined_clazz(ret_type)) {
-                        error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
-                            ret_type + "is undefined");
+                depend(DependencyKind::clazz, n.get_data(DataType::type));
+                ret_type = s->get_type_ref(n.get_data(DataType::type));
+                if(ret_type.is_none()) {
+                    error_vector.emplace_back(ErrorType::semantical, n.get_line(), n.get_column(), 
+                        n.get_data(DataType::type) + "is undefined");
 
-                        ret_type = std::string("unit");
+                    ret_type = TypeRef::unit;
                 }
             }
-            n.set_return_type(ret_type);
-            return n;
+            return annotate(n, ret_type);
 
         default:
-            ret_type = n.get_data(DataType::type);
-            n.set_return_type(ret_type);
-            return n;
+            // Literals
+            ret_type = TypeRef::of_primitive(n.get_data(DataType::type));
+            n.set_type_ref(ret_type);
+            return ret_type;
     }
 }
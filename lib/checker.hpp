@@ -10,50 +10,185 @@
  */
 #include "node.hpp"
 #include "error.hpp"
+#include "scope.hpp"
+#include "type_ref.hpp"
 
 #include <vector>
 #include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
 #ifndef VSOPCOMPILER_CHECKER_H
 #define VSOPCOMPILER_CHECKER_H
 
+enum class DependencyKind { clazz, field, method };
+
+/*
+ * Dependency
+ *
+ * A lookup in the SymbolTable a method check relied on.
+ */
+struct Dependency {
+    DependencyKind kind; // What is looked up
+    TypeRef clazz; // The clazz looked up, or the clazz the member is looked up in
+    std::string id; // The member looked up, or the name of an undefined clazz (clazz is none)
+
+    bool operator<(const Dependency &other) const;
+};
+
+/*
+ * MethodRecord
+ *
+ * The result of checking a method, kept so that a later Checker can reuse it.
+ */
+struct MethodRecord {
+    size_t hash; // The hash of the method as parsed, relative to its line
+    std::vector<std::pair<Dependency, std::string> > dependencies; // The < dependency - value > pairs the check relied on
+    std::vector<Error> errors; // The errors found in the method, relative to its line
+    std::vector<Node *> resolved; // The nodes of the body resolved to a declaration
+};
+
 class Checker {
     private:
-        Node expAST; // A reference to the root of an AST
+        Node expAST; // The root of the AST, annotated in place
         std::vector<Error> error_vector; // A vector of errors
+        int jobs; // The number of threads checking the method bodies
+        bool incremental; // true to record what a later Checker needs to reuse the methods
+        Checker *previous; // The previous Checker whose method records can be reused, if any
+        std::vector<std::pair<std::string, Node *> > methods; // Each method with its clazz, in visiting order
+        std::vector<MethodRecord> records; // The record of each method, in visiting order
+        std::unordered_map<std::string, size_t> record_index; // A < "clazz.method" - record > mapping
+        std::vector<std::string> type_names; // The clazz name of each clazz number
+        bool renumbered; // true if the clazz numbers differ from the ones of previous
+        std::set<Dependency> dependencies; // The dependencies of the method being checked
+        std::map<Dependency, std::string> values; // A < dependency - value > cache, valid during check
+        std::vector<Node *> resolved; // The nodes resolved to a declaration by the method being checked
+        size_t next_checked; // The index of the next checked method to merge
+        size_t reused; // The number of methods reused from previous
 
         /*
          * build
          *
-         * Populate the symbol table
+         * Populate the symbol table and check the declared types of the fields, methods and formals.
+         * Undefined field and method types are replaced by unit.
          */
         void build(); 
 
+        /*
+         * check_methods
+         *
+         * Check every method body in place, reusing the records of previous when possible. The other
+         * methods are checked on a pool of jobs threads, each with its own error vector. A thread only
+         * writes into the body of the method it checks. The errors are merged by check_typecast in 
+         * visiting order, so they are the same as a sequential check. 
+         * Requires a frozen SymbolTable.
+         */
+        void check_methods();
+
+        /*
+         * reuse_method
+         *
+         * input:
+         *      i - the index of the method in visiting order.
+         *
+         * Reuse the record of previous for the method if its hash and the values of its
+         * dependencies are unchanged. The annotated body of previous is swapped with the new
+         * one, so its nodes keep their address, moved to the line of the new method. Only its
+         * declarations are resolved again.
+         *
+         * return:
+         *      true if the method has been reused,
+         *      false if it must be checked.
+         */
+        bool reuse_method(size_t i);
+
+        /*
+         * renumber
+         *
+         * input:
+         *      n - a node taken from the AST of previous.
+         *
+         * Translate the clazz numbers of the subtree rooted at n to the current SymbolTable.
+         */
+        void renumber(Node &n);
+
+        /*
+         * depend
+         *
+         * input:
+         *      kind - what is looked up.
+         *      clazz - the clazz (or type) looked up, by name or interned.
+         *      id - the member looked up, if any.
+         *
+         * Record a dependency of the method being checked, in incremental mode only.
+         * The primitive types are not recorded, nothing can change them.
+         */
+        void depend(DependencyKind kind, const std::string &clazz, const std::string &id = std::string());
+        void depend(DependencyKind kind, TypeRef clazz, const std::string &id = std::string());
+
+        /*
+         * dependency_value
+         *
+         * input:
+         *      dependency - a dependency recorded by depend.
+         *
+         * return:
+         *      what the dependency resolves to in the SymbolTable: the ancestors of a clazz, the 
+         *      type and index of a field or the signature and index of a method, empty if undefined.
+         *      Each dependency is resolved once per check.
+         */
+        const std::string &dependency_value(const Dependency &dependency);
+
+        /*
+         * annotate
+         *
+         * input:
+         *      n - the node to annotate.
+         *      t - the type of the node.
+         *
+         * Set the interned type of n, and its type name for display.
+         * 
+         * return:
+         *      t.
+         */
+        TypeRef annotate(Node &n, TypeRef t);
+
         /*
          * check typecast
          *
+         * Set the type of each expression node of n in place, and the declaration (with its
+         * structure or vtable index) each field identifier, field assignment and call resolves to.
+         *
          * input:
          *      n - the AST to check.
-         *      local_var - a < defined variable - type > mapping.
+         *      local_var - the scope of the local variables (restored on return).
          *      curr_clazz - the current clazz.
          *      ints - true if we are in an instantiation context, false otherwise.
          *
          * return:
-         *      n - a checked AST with each sub node type set/modified.
+         *      the type of n.
          */
-        Node check_typecast(Node &n, std::map<std::string, std::string> local_var = std::map<std::string, std::string>(), std::string cur_clazz = std::string(), bool inst = false);
+        TypeRef check_typecast(Node &n, Scope &local_var, const std::string &cur_clazz = std::string(), bool inst = false);
 
     public:
         /*
          * Checker constructor
          *
          * input:
-         *      ast - a reference to an AST.
+         *      ast - the AST to check, moved in to avoid a copy.
+         *      j - the number of threads used to check the method bodies.
+         *      incr - true to record the hashes and dependencies of the methods, so that a
+         *             later Checker can reuse them (implied by p).
+         *      p - a previous Checker, alive until check returns, whose results are reused 
+         *          for the unchanged methods (nullptr to check everything). It gives the 
+         *          annotated bodies of these methods away and must not be used afterwards.
          * 
          * return:
          *      A Checker instance.
          */
-        Checker(Node ast);
+        Checker(Node ast, int j = 1, bool incr = false, Checker *p = nullptr);
 
         /*
          * check
@@ -68,9 +203,9 @@ class Checker {
          * get_expanded_AST
          *
          * return:
-         *      the checked AST.
+         *      a reference to the checked AST, valid as long as the Checker.
          */
-        Node get_expanded_AST();
+        Node &get_expanded_AST();
 
         /*
          * Node constructor
@@ -79,6 +214,22 @@ class Checker {
          *      A vector of semantical errors.
          */
         std::vector<Error> get_errors();
+
+        /*
+         * get_reused_count
+         *
+         * return:
+         *      the number of methods whose results were reused from the previous Checker.
+         */
+        size_t get_reused_count() const;
+
+        /*
+         * get_method_count
+         *
+         * return:
+         *      the number of methods checked or reused.
+         */
+        size_t get_method_count() const;
 };
 
 #endif //VSOPCOMPILER_CHECKER_H
\ No newline at end of file
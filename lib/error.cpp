@@ -30,6 +30,14 @@ bool Error::compare(Error e1, Error e2) {
     return (e1.column < e2.column);
 }
 
+void Error::shift_lines(int delta) {
+    line += delta;
+}
+
+bool Error::operator==(const Error &other) const {
+    return type == other.type && line == other.line && column == other.column && message == other.message;
+}
+
 void Error::print_error_msg() {
     std::cerr << filename << ":" << line << ":" << column << ":";
     switch(type) {
@@ -66,6 +66,23 @@ class Error
          *      false otherwise.
          */
         static bool compare(Error e1, Error e2);
+
+        /*
+         * shift_lines
+         *
+         * input:
+         *      delta - the number of lines to move the error by.
+         */
+        void shift_lines(int delta);
+
+        /*
+         * operator==
+         *
+         * return:
+         *      true  the errors are of the same type, at the same position, with the same message;
+         *      false otherwise.
+         */
+        bool operator==(const Error &other) const;
 };
 
 #endif //VSOPCOMPILER_ERROR_H
\ No newline at end of file
@@ -11,6 +11,14 @@
 
 #include "generator.hpp"
 #include "symbol_table.hpp"
+#include "stack_allocation.hpp"
+#include "stack_segment.hpp"
+#include "type_ref.hpp"
+
+extern "C" {
+#include "../runtime/object.h"
+#include "../runtime/external.h"
+}
 
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/STLExtras.h"
@@ -18,15 +26,24 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/CallingConv.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Linker/Linker.h"
 #include "llvm/IR/Argument.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/GlobalObject.h"
@@ -35,13 +52,30 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Value.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/PassTimingInfo.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/AtomicOrdering.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/Internalize.h"
+#include "llvm/Transforms/Scalar/SROA.h"
 
 #include <cstdlib>
 #include <fstream>
 #include <map>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -49,6 +83,10 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #define _FUNCTION_PADDING "__"
 #define _VTABLE_PADDING "___"
@@ -56,14 +94,73 @@
 #define _NEW_ "_new"
 #define _INIT "_init"
 #define _MALLOC "malloc"
-#define _POWER "power"
+#define _PROFILE_BEGIN "profile_begin"
+#define _PROFILE_COUNT "profile_count"
+#define _PROFILE_END "profile_end"
 #define _EXT_SIZE 5
 
-static std::unique_ptr<llvm::LLVMContext> llvm_context; // Unique pointer to the LLVM context
-static std::unique_ptr<llvm::Module> llvm_module; // Unique pointer to the LLVM module
-static std::unique_ptr<llvm::IRBuilder<> > llvm_builder; // Unique pointer to the LLVM IR builder
-static std::map<std::string, std::map<std::string, int> > field_index_map; // Map used to store indexes of the field definition
-static std::map<std::string, std::map<std::string, int> > method_index_map; // Map used to store indexes of the method definition
+// The state of the module being generated, one per thread when partitioned
+static thread_local std::unique_ptr<llvm::LLVMContext> llvm_context; // Unique pointer to the LLVM context
+static thread_local std::unique_ptr<llvm::Module> llvm_module; // Unique pointer to the LLVM module
+static thread_local std::unique_ptr<llvm::IRBuilder<> > llvm_builder; // Unique pointer to the LLVM IR builder
+static thread_local std::unique_ptr<llvm::TargetMachine> llvm_target_machine; // Unique pointer to the host target machine, if any
+static thread_local std::vector<llvm::StructType *> llvm_clazz_types; // The structure of each clazz, by clazz number
+static thread_local std::vector<llvm::StructType *> llvm_vtable_types; // The vtable structure of each clazz, by clazz number
+static thread_local std::vector<llvm::GlobalVariable *> llvm_vtables; // The vtable global of each clazz (except Object), by clazz number
+static thread_local std::vector<llvm::Function *> llvm_new_functions; // The 'new' function of each clazz, by clazz number
+static thread_local std::vector<llvm::Function *> llvm_init_functions; // The 'init' function of each clazz, by clazz number
+static thread_local std::unordered_map<const Node *, llvm::Function *> llvm_methods; // The function of each method declaration
+static thread_local std::unordered_map<std::string, llvm::Constant *> string_pool; // The pointer to the constant of each distinct string literal, by decoded bytes
+static thread_local int partition = 0; // The partition of the program in the module
+static thread_local int partitions = 1; // The number of partitions, the clazz number c being in partition c % partitions
+static thread_local int polymorphic_sites; // The number of call sites left virtual, which numbers them in the profile
+static thread_local llvm::Value *llvm_self; // The receiver of the function being generated
+static thread_local std::vector<llvm::Value *> llvm_formals; // The slots of the formals of the method being generated
+static thread_local std::vector<std::pair<llvm::Value *, llvm::ConstantInt *> > live_lets; // The slots (and sizes) of the let variables in scope
+static thread_local std::set<const Node *> tail_calls; // The calls in tail position in the method being generated
+static thread_local llvm::BasicBlock *tail_loop; // The block its self-recursive tail calls jump back to, if any
+static thread_local llvm::PHINode *tail_self; // The receiver of the current iteration of tail_loop
+
+/*
+ * ModuleState
+ *
+ * The thread_local state above, carried to the thread of a new stack segment.
+ */
+struct ModuleState {
+    std::unique_ptr<llvm::LLVMContext> llvm_context;
+    std::unique_ptr<llvm::Module> llvm_module;
+    std::unique_ptr<llvm::IRBuilder<> > llvm_builder;
+    std::unique_ptr<llvm::TargetMachine> llvm_target_machine;
+    std::vector<llvm::StructType *> llvm_clazz_types;
+    std::vector<llvm::StructType *> llvm_vtable_types;
+    std::vector<llvm::GlobalVariable *> llvm_vtables;
+    std::vector<llvm::Function *> llvm_new_functions;
+    std::vector<llvm::Function *> llvm_init_functions;
+    std::unordered_map<const Node *, llvm::Function *> llvm_methods;
+    std::unordered_map<std::string, llvm::Constant *> string_pool;
+    int partition = 0;
+    int partitions = 1;
+    int polymorphic_sites = 0;
+    llvm::Value *llvm_self = nullptr;
+    std::vector<llvm::Value *> llvm_formals;
+    std::vector<std::pair<llvm::Value *, llvm::ConstantInt *> > live_lets;
+    std::set<const Node *> tail_calls;
+    llvm::BasicBlock *tail_loop = nullptr;
+    llvm::PHINode *tail_self = nullptr;
+};
+
+static std::atomic<size_t> call_sites; // The number of generated call sites
+static std::atomic<size_t> devirtualized_calls; // The number of call sites bound statically by class hierarchy analysis
+static std::atomic<size_t> speculated_calls; // The number of call sites guarded by a vtable compare from the profile
+static std::atomic<size_t> looped_calls; // The number of self-recursive tail calls turned into loops
+static std::atomic<size_t> guaranteed_calls; // The number of tail calls marked 'musttail'
+static std::atomic<size_t> hinted_calls; // The number of tail calls marked 'tail'
+static bool report_tail; // true to record each tail call in tail_report
+static std::mutex report_mutex; // Guards tail_report and the pass timings, the partitions being generated concurrently
+static std::vector<std::tuple<int, int, std::string> > tail_report; // A < line - column - outcome > entry per tail call
+static std::string profile_output; // The file the instrumented program writes its profile to, empty if not instrumented
+static std::vector<std::pair<llvm::GlobalVariable *, std::vector<TypeRef> > > profile_counters; // The counters of each instrumented site, by receiver clazz
+static std::map<int, std::map<std::string, long long> > profile; // A < site - receiver clazz - count > mapping read from a profile
 
 
 /*
@@ -76,6 +173,13 @@ static std::map<std::string, std::map<std::string, int> > method_index_map; // M
  */
 static void initialize_module(std::string &filename);
 
+/*
+ * release_module
+ *
+ * Destroy the module of the current thread, before its context.
+ */
+static void release_module();
+
 /*
  * build_structures
  *
@@ -83,29 +187,40 @@ static void initialize_module(std::string &filename);
  */
 static void build_structures();
 
+/*
+ * swap_module_state
+ *
+ * input:
+ *      state - the state to exchange with the one of the current thread.
+ *
+ * Hand the state of the current thread over to state, and take the one it held.
+ */
+static void swap_module_state(ModuleState &state);
+
 /*
  * codegen
  *
  * input:
  *      n - a reference to an abstract syntax tree.        
- *      clazz_name - the current clazz.
- *      named_value - a map if the local variables with their LLVM Value representation.
+ *      cur_clazz - the current clazz.
+ *      named_value - a map if the local variables with their LLVM Value representation,
+ *                    restored on return.
  * 
  * return:
  *      value - the LLVM Value representation of n.
  */
-static llvm::Value *codegen(Node &n, std::string clazz_name = "", std::map<std::string, llvm::Value * > named_value = std::map<std::string, llvm::Value * >());
+static llvm::Value *codegen(const Node &n, TypeRef cur_clazz, std::map<std::string, llvm::Value * > &named_value);
 
 /*
  * get_llvm_type
  *
  * input:        
- *      type - a string representing the type to translate.
+ *      type - the interned type to translate.
  * 
  * return:
  *      type - the LLVM Type representation of the input type.
  */
-static llvm::Type *get_llvm_type(std::string type);
+static llvm::Type *get_llvm_type(TypeRef type);
 
 /*
  * format_string
@@ -117,27 +232,454 @@ static llvm::Type *get_llvm_type(std::string type);
  */
 static void format_string(std::string &str);
 
+/*
+ * get_string
+ *
+ * input:
+ *      str - the decoded bytes of a string literal.
+ *
+ * Pool the string literals of the module, each distinct one being a single private unnamed_addr constant.
+ * 
+ * return:
+ *      a pointer to the first character of the pooled constant.
+ */
+static llvm::Constant *get_string(const std::string &str);
+
+/*
+ * create_entry_alloca
+ *
+ * input:
+ *      type - the type of the local variable.
+ *      name - the name of the local variable.
+ *
+ * Allocate a local variable at the top of the entry block of the current function, so that it is allocated
+ * once per call wherever it is declared, and can be promoted to a register.
+ * 
+ * return:
+ *      the address of the local variable.
+ */
+static llvm::AllocaInst *create_entry_alloca(llvm::Type *type, const std::string &name);
+
+/*
+ * build_power
+ *
+ * input:
+ *      x - the int32 base.
+ *      y - the int32 exponent.
+ *
+ * Compute x^y by squaring, wrapping around like the other int32 operations. A negative exponent gives
+ * the truncated 1/x^-y, that is x^-y for x = 1 or -1 and 0 otherwise.
+ * The power is folded when both operands are constant, and unrolled when the exponent is.
+ * 
+ * return:
+ *      the int32 value of x^y.
+ */
+static llvm::Value *build_power(llvm::Value *x, llvm::Value *y);
+
+/*
+ * instrument_site
+ *
+ * input:
+ *      site - the number of the call site.
+ *      receiver - the static clazz of the receiver.
+ *      vtable - the vtable loaded from the receiver.
+ *
+ * Count the clazz of the receiver at the call site, the clazzes being told apart by their vtable.
+ */
+static void instrument_site(int site, TypeRef receiver, llvm::Value *vtable);
+
+/*
+ * write_profile
+ *
+ * Write the counters of all instrumented sites to profile_output before 'main' returns.
+ */
+static void write_profile();
+
+/*
+ * get_hot_clazz
+ *
+ * input:
+ *      site - the number of the call site.
+ *      receiver - the static clazz of the receiver.
+ * 
+ * return:
+ *      the clazz receiving the majority of the calls at the site in the profile, 
+ *      none if there is no such clazz.
+ */
+static TypeRef get_hot_clazz(int site, TypeRef receiver);
+
+/*
+ * find_tail_calls
+ *
+ * input:
+ *      n - an expression whose value is the value of the method.
+ *      calls - filled with the calls in tail position in n.
+ *
+ * The value of a block is the value of its last expression, the value of a conditional the value of
+ * one of its branches, and the value of a let the value of its scope.
+ */
+static void find_tail_calls(const Node &n, std::set<const Node *> &calls);
+
+/*
+ * get_calling_conv
+ *
+ * input:
+ *      slot - the vtable index of a method.
+ *
+ * The methods inherited from Object are implemented by the runtime and keep the C calling convention,
+ * as do their overrides sharing the slot; the others are only called from the module and use fastcc.
+ * 
+ * return:
+ *      the calling convention of the functions bound to the slot, and of their calls.
+ */
+static llvm::CallingConv::ID get_calling_conv(int slot);
+
+/*
+ * build_tail_call
+ *
+ * input:
+ *      n - a call in tail position.
+ *      f_type - the type of the function called.
+ *      f - the function called.
+ *      args - the arguments of the call, the receiver first.
+ *
+ * Return the value of the call from the current method. A call of the method itself jumps back to its top
+ * with the arguments as receiver and formals; another call is a guaranteed tail call (musttail) if its prototype
+ * matches the one of the method, and may be one (tail) otherwise. The code that follows is unreachable.
+ * 
+ * return:
+ *      an undefined value of the type of the call.
+ */
+static llvm::Value *build_tail_call(const Node &n, llvm::FunctionType *f_type, llvm::Value *f, std::vector<llvm::Value * > &args);
+
 Generator::Generator(Node &ast, std::string &filename) {
-    this->ast = ast;
+    this->ast = &ast;
+    this->module_name = filename;
     initialize_module(filename);
 }
 
+Generator::~Generator() {
+    release_module();
+}
+
 void Generator::generate() {
-    codegen(ast);
+    std::map<std::string, llvm::Value * > named_value;
+    codegen(*ast, TypeRef(), named_value);
+
+    if(!profile_output.empty()) {
+        write_profile();
+    }
     return;
 }
 
+int Generator::compile_partitions(int jobs, int level, const std::string &passes, bool time_passes, const std::string &runtime, 
+    const std::string &prefix, std::vector<std::string> &objects) {
+
+    objects.clear();
+    for(int k = 0; k < jobs; ++k) {
+        objects.push_back(prefix + "." + std::to_string(k) + ".o");
+    }
+
+    // Each partition is generated, optimized and emitted in its own context
+    std::vector<int> results(jobs, 0);
+    std::vector<std::set<std::string>> used(jobs);
+    std::mutex mutex;
+    std::condition_variable arrived;
+    int waiting = 0;
+    int generation = 0;
+    auto wait_all = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        int current = generation;
+        if(++waiting == jobs) {
+            waiting = 0;
+            ++generation;
+            arrived.notify_all();
+        } else {
+            arrived.wait(lock, [&]() { return generation != current; });
+        }
+    };
+
+    auto worker = [&](int k) {
+        partition = k;
+        partitions = jobs;
+        initialize_module(module_name);
+
+        std::map<std::string, llvm::Value * > named_value;
+        codegen(*ast, TypeRef(), named_value);
+        if(!runtime.empty() && link_runtime(runtime) != 0) {
+            results[k] = -1;
+        }
+
+        // Only keep external what the other partitions use, until no partition removes anything more
+        std::vector<std::set<std::string>> previous;
+        while(!runtime.empty()) {
+            std::set<std::string> uses;
+            for(auto &value : llvm_module->global_values()) {
+                if(value.isDeclaration() && !value.use_empty()) {
+                    uses.insert(value.getName().str());
+                }
+            }
+            used[k] = std::move(uses);
+            wait_all();
+
+            bool stable = (used == previous);
+            previous = used;
+            std::set<std::string> exported = {"main"};
+            for(int other = 0; other < jobs; ++other) {
+                if(other != k) {
+                    exported.insert(used[other].begin(), used[other].end());
+                }
+            }
+            wait_all();
+            if(stable) {
+                break;
+            }
+
+            llvm::internalizeModule(* llvm_module, [&](const llvm::GlobalValue &value) { return exported.count(value.getName().str()) != 0; });
+            llvm::legacy::PassManager pass_manager;
+            pass_manager.add(llvm::createGlobalDCEPass());
+            pass_manager.run(* llvm_module);
+        }
+
+        if(results[k] == 0 && (optimize(level, passes, time_passes) != 0 || emit(objects[k], false) != 0)) {
+            results[k] = -1;
+        }
+        release_module();
+    };
+
+    std::vector<std::thread> pool;
+    for(int k = 0; k < jobs; ++k) {
+        pool.emplace_back(worker, k);
+    }
+    for(auto &thread : pool) {
+        thread.join();
+    }
+
+    return (std::count(results.begin(), results.end(), 0) == jobs) ? 0 : -1;
+}
+
+void Generator::instrument(const std::string &filename) {
+    profile_output = filename;
+}
+
+int Generator::use_profile(const std::string &filename) {
+    std::ifstream file(filename);
+    if(!file.is_open()) {
+        return -1;
+    }
+
+    // One 'site clazz count' line per receiver clazz seen at a call site
+    int site;
+    std::string clazz;
+    long long count;
+    while(file >> site >> clazz >> count) {
+        profile[site][clazz] += count;
+    }
+    return 0;
+}
+
+int Generator::link_runtime(const std::string &filename) {
+    llvm::SMDiagnostic diagnostic;
+    std::unique_ptr<llvm::Module> runtime = llvm::parseIRFile(filename, diagnostic, * llvm_context);
+    if(runtime == nullptr) {
+        diagnostic.print("vsopc", llvm::errs());
+        return -1;
+    }
+    runtime->setDataLayout(llvm_module->getDataLayout());
+    runtime->setTargetTriple(llvm_module->getTargetTriple());
+
+    // Only link the runtime definitions the program needs
+    if(llvm::Linker::linkModules(* llvm_module, std::move(runtime), llvm::Linker::Flags::LinkOnlyNeeded)) {
+        return -1;
+    }
+
+    // The program is whole: everything but 'main' can be inlined or removed (partitions first agree on what they share)
+    if(partitions == 1) {
+        llvm::internalizeModule(* llvm_module, [](const llvm::GlobalValue &value) { return value.getName() == "main"; });
+    }
+    return 0;
+}
+
+int Generator::optimize(int level, const std::string &passes, bool time_passes) {
+    // The code generator follows the same level
+    if(llvm_target_machine != nullptr) {
+        const llvm::CodeGenOpt::Level codegen_levels[] = {llvm::CodeGenOpt::None, llvm::CodeGenOpt::Less, 
+            llvm::CodeGenOpt::Default, llvm::CodeGenOpt::Aggressive};
+        llvm_target_machine->setOptLevel(codegen_levels[std::max(0, std::min(level, 3))]);
+    }
+
+    std::string pipeline = passes;
+    if(pipeline.empty() && level <= 0) {
+        pipeline = "function(mem2reg)"; // -O0 only promotes the local variables to registers
+    } else if(pipeline.empty()) {
+        pipeline = "default<O" + std::to_string(std::min(level, 3)) + ">";
+    }
+
+    // Time each pass if asked
+    llvm::PassInstrumentationCallbacks instrumentation;
+    llvm::TimePassesHandler timer(time_passes);
+    timer.registerCallbacks(instrumentation);
+
+    // Register the analyses of each IR unit, and the proxies between them
+    llvm::PassBuilder builder(llvm_target_machine.get(), llvm::PipelineTuningOptions(), llvm::None, &instrumentation);
+    llvm::LoopAnalysisManager loop_analyses;
+    llvm::FunctionAnalysisManager function_analyses;
+    llvm::CGSCCAnalysisManager cgscc_analyses;
+    llvm::ModuleAnalysisManager module_analyses;
+
+    builder.registerModuleAnalyses(module_analyses);
+    builder.registerCGSCCAnalyses(cgscc_analyses);
+    builder.registerFunctionAnalyses(function_analyses);
+    builder.registerLoopAnalyses(loop_analyses);
+    builder.crossRegisterProxies(loop_analyses, function_analyses, cgscc_analyses, module_analyses);
+
+    // Move the objects that do not escape to the stack once inlined, then scalar replace them
+    builder.registerScalarOptimizerLateEPCallback([](llvm::FunctionPassManager &functions, auto) {
+        functions.addPass(StackAllocation());
+        functions.addPass(llvm::SROA());
+    });
+    builder.registerPipelineParsingCallback([](llvm::StringRef name, llvm::FunctionPassManager &functions, 
+        llvm::ArrayRef<llvm::PassBuilder::PipelineElement>) {
+        if(name == "stack-alloc") {
+            functions.addPass(StackAllocation());
+            return true;
+        }
+        return false;
+    });
+
+    llvm::ModulePassManager pass_manager;
+    if(llvm::Error error = builder.parsePassPipeline(pass_manager, pipeline)) {
+        llvm::errs() << "Invalid pass pipeline '" << pipeline << "': " << llvm::toString(std::move(error)) << "\n";
+        return -1;
+    }
+    pass_manager.run(*llvm_module, module_analyses);
+
+    if(time_passes) {
+        // One report per partition, each printed at once
+        std::lock_guard<std::mutex> lock(report_mutex);
+        if(partitions > 1) {
+            llvm::errs() << "Partition " << partition << ":\n";
+        }
+        timer.print();
+    }
+    return 0;
+}
+
+void Generator::print_stats() {
+    std::cerr << "devirtualized " << devirtualized_calls << " of " << call_sites << " call sites (class hierarchy analysis), " 
+        << "speculated " << speculated_calls << " (profile)" << std::endl;
+    std::cerr << "allocated " << StackAllocation::get_allocations() << " objects on the stack (escape analysis)" << std::endl;
+    std::cerr << "tail calls: " << looped_calls << " turned into loops, " << guaranteed_calls << " guaranteed (musttail), " 
+        << hinted_calls << " marked tail" << std::endl;
+}
+
+void Generator::report_tail_calls() {
+    report_tail = true;
+}
+
+void Generator::print_tail_calls() {
+    std::lock_guard<std::mutex> lock(report_mutex);
+    std::sort(tail_report.begin(), tail_report.end());
+    for(auto &entry : tail_report) {
+        std::cerr << module_name << ":" << std::get<0>(entry) << ":" << std::get<1>(entry) << ": " << std::get<2>(entry) << std::endl;
+    }
+}
+
 void Generator::print() {
     llvm_module->print(llvm::outs(), nullptr);
 }
 
-int Generator::save(std::string &filename) {
+int Generator::emit(std::string &filename, bool assembly) {
+    if(llvm_target_machine == nullptr) {
+        std::cerr << "No target available for " << llvm::sys::getDefaultTargetTriple() << std::endl;
+        return -1;
+    }
+
     std::error_code error;
+    llvm::raw_fd_ostream fd(filename, error, llvm::sys::fs::OF_None);
+    if(error) {
+        return -1;
+    }
 
-    llvm::raw_fd_ostream fd(filename, error);
-    llvm_module->print(fd, nullptr);
+    // Run the code generator of the host on the module
+    llvm::legacy::PassManager pass_manager;
+    auto file_type = assembly ? llvm::CGFT_AssemblyFile : llvm::CGFT_ObjectFile;
+    if(llvm_target_machine->addPassesToEmitFile(pass_manager, fd, nullptr, file_type)) {
+        std::cerr << "The host target cannot emit this file type" << std::endl;
+        return -1;
+    }
+    pass_manager.run(*llvm_module);
+    fd.flush();
 
-    return error.value();
+    return fd.has_error() ? -1 : 0;
+}
+
+int Generator::run() {
+    using namespace llvm::orc;
+
+    // Build a JIT for the host, with the level of the code generator
+    auto target_builder = JITTargetMachineBuilder::detectHost();
+    if(!target_builder) {
+        llvm::errs() << llvm::toString(target_builder.takeError()) << "\n";
+        return -1;
+    }
+    if(llvm_target_machine != nullptr) {
+        target_builder->setCodeGenOptLevel(llvm_target_machine->getOptLevel());
+    }
+
+    auto jit = LLJITBuilder().setJITTargetMachineBuilder(std::move(*target_builder)).create();
+    if(!jit) {
+        llvm::errs() << llvm::toString(jit.takeError()) << "\n";
+        return -1;
+    }
+
+    // Resolve the runtime with its definitions linked in vsopc
+    SymbolMap runtime;
+    auto define = [&](const char *name, void *address) {
+        runtime[(*jit)->mangleAndIntern(name)] = llvm::JITEvaluatedSymbol(
+            llvm::pointerToJITTargetAddress(address), llvm::JITSymbolFlags::Exported);
+    };
+    define("Object___new", reinterpret_cast<void *>(&Object___new));
+    define("Object___init", reinterpret_cast<void *>(&Object___init));
+    define("Object__print", reinterpret_cast<void *>(&Object__print));
+    define("Object__printBool", reinterpret_cast<void *>(&Object__printBool));
+    define("Object__printInt32", reinterpret_cast<void *>(&Object__printInt32));
+    define("Object__inputLine", reinterpret_cast<void *>(&Object__inputLine));
+    define("Object__inputBool", reinterpret_cast<void *>(&Object__inputBool));
+    define("Object__inputInt32", reinterpret_cast<void *>(&Object__inputInt32));
+    define(_MALLOC, reinterpret_cast<void *>(&malloc));
+    define(_PROFILE_BEGIN, reinterpret_cast<void *>(&profile_begin));
+    define(_PROFILE_COUNT, reinterpret_cast<void *>(&profile_count));
+    define(_PROFILE_END, reinterpret_cast<void *>(&profile_end));
+
+    if(llvm::Error error = (*jit)->getMainJITDylib().define(absoluteSymbols(std::move(runtime)))) {
+        llvm::errs() << llvm::toString(std::move(error)) << "\n";
+        return -1;
+    }
+
+    // The C library, called by the runtime once linked in the module
+    auto process = DynamicLibrarySearchGenerator::GetForCurrentProcess((*jit)->getDataLayout().getGlobalPrefix());
+    if(!process) {
+        llvm::errs() << llvm::toString(process.takeError()) << "\n";
+        return -1;
+    }
+    (*jit)->getMainJITDylib().addGenerator(std::move(*process));
+
+    // Hand the module over to the JIT, then call main
+    llvm_builder.reset();
+    if(llvm::Error error = (*jit)->addIRModule(ThreadSafeModule(std::move(llvm_module), std::move(llvm_context)))) {
+        llvm::errs() << llvm::toString(std::move(error)) << "\n";
+        return -1;
+    }
+
+    auto main_symbol = (*jit)->lookup("main");
+    if(!main_symbol) {
+        llvm::errs() << llvm::toString(main_symbol.takeError()) << "\n";
+        return -1;
+    }
+
+    auto main_function = reinterpret_cast<int32_t (*)()>(main_symbol->getAddress());
+    return main_function();
 }
 
 void initialize_module(std::string &filename) {
@@ -147,47 +689,107 @@ void initialize_module(std::string &filename) {
     llvm_module = std::make_unique<Module>(filename, *llvm_context);
     llvm_builder = std::make_unique<IRBuilder<>>(*llvm_context);
 
+    // Target the host, so that the module is optimized for it and emitted without leaving the process
+    static std::once_flag target_initialized; // The TargetRegistry is shared by the partitions
+    std::call_once(target_initialized, []() {
+        InitializeNativeTarget();
+        InitializeNativeTargetAsmPrinter();
+    });
+
+    std::string triple = sys::getDefaultTargetTriple();
+    std::string error;
+    const Target *target = TargetRegistry::lookupTarget(triple, error);
+    if(target != nullptr) {
+        llvm_target_machine.reset(target->createTargetMachine(triple, sys::getHostCPUName(), "", 
+            TargetOptions(), Optional<Reloc::Model>(Reloc::PIC_)));
+        llvm_module->setTargetTriple(triple);
+        llvm_module->setDataLayout(llvm_target_machine->createDataLayout());
+    }
+
     // Initialize all classes and vtables structures with defined and inhereted fields and methods.
     build_structures();
 }
 
+void release_module() {
+    llvm_builder.reset();
+    llvm_module.reset();
+    llvm_target_machine.reset();
+    llvm_clazz_types.clear();
+    llvm_vtable_types.clear();
+    llvm_vtables.clear();
+    llvm_new_functions.clear();
+    llvm_init_functions.clear();
+    llvm_methods.clear();
+    string_pool.clear();
+    llvm_context.reset();
+}
+
+void swap_module_state(ModuleState &state) {
+    std::swap(llvm_context, state.llvm_context);
+    std::swap(llvm_module, state.llvm_module);
+    std::swap(llvm_builder, state.llvm_builder);
+    std::swap(llvm_target_machine, state.llvm_target_machine);
+    std::swap(llvm_clazz_types, state.llvm_clazz_types);
+    std::swap(llvm_vtable_types, state.llvm_vtable_types);
+    std::swap(llvm_vtables, state.llvm_vtables);
+    std::swap(llvm_new_functions, state.llvm_new_functions);
+    std::swap(llvm_init_functions, state.llvm_init_functions);
+    std::swap(llvm_methods, state.llvm_methods);
+    std::swap(string_pool, state.string_pool);
+    std::swap(partition, state.partition);
+    std::swap(partitions, state.partitions);
+    std::swap(polymorphic_sites, state.polymorphic_sites);
+    std::swap(llvm_self, state.llvm_self);
+    std::swap(llvm_formals, state.llvm_formals);
+    std::swap(live_lets, state.live_lets);
+    std::swap(tail_calls, state.tail_calls);
+    std::swap(tail_loop, state.tail_loop);
+    std::swap(tail_self, state.tail_self);
+}
+
 void build_structures() {
     SymbolTable *s = SymbolTable::getInstance();
 
     // Declare all class structures
+    llvm_clazz_types.assign(s->get_clazz_count(), nullptr);
     for(auto &clazz : s->get_defined_clazzes(true)) {
-        std::string type = clazz.get_data(DataType::type);
-        llvm::StructType::create(* llvm_context, type);
+        std::string type = clazz->get_data(DataType::type);
+        llvm_clazz_types[clazz->get_type_ref().get_clazz()] = llvm::StructType::create(* llvm_context, type);
     }
 
     // Declare all type vtable structures
+    llvm_vtable_types.assign(s->get_clazz_count(), nullptr);
     for(auto &clazz : s->get_defined_clazzes(true)) {
-        std::string type = clazz.get_data(DataType::type);
-        llvm::StructType::create(* llvm_context, type + _VTABLE);
+        std::string type = clazz->get_data(DataType::type);
+        llvm_vtable_types[clazz->get_type_ref().get_clazz()] = llvm::StructType::create(* llvm_context, type + _VTABLE);
     }
 
     // Declare EXTERNAL 'new' function for Object
-    auto new_f = llvm::FunctionType::get(get_llvm_type("Object"), false);
-    llvm::Function::Create(new_f, llvm::Function::ExternalLinkage, std::string("Object") + _FUNCTION_PADDING + _NEW_, llvm_module.get());
+    llvm_new_functions.assign(s->get_clazz_count(), nullptr);
+    auto new_f = llvm::FunctionType::get(get_llvm_type(TypeRef::clazz(0)), false);
+    llvm_new_functions[0] = llvm::Function::Create(new_f, llvm::Function::ExternalLinkage, 
+        std::string("Object") + _FUNCTION_PADDING + _NEW_, llvm_module.get());
 
     // Declare EXTERNAL 'init' function for Object
-    auto init_f = llvm::FunctionType::get(get_llvm_type("Object"), {get_llvm_type("Object")}, false);
-    llvm::Function::Create(init_f, llvm::Function::ExternalLinkage, std::string("Object") + _FUNCTION_PADDING + _INIT, llvm_module.get());
+    llvm_init_functions.assign(s->get_clazz_count(), nullptr);
+    auto init_f = llvm::FunctionType::get(get_llvm_type(TypeRef::clazz(0)), {get_llvm_type(TypeRef::clazz(0))}, false);
+    llvm_init_functions[0] = llvm::Function::Create(init_f, llvm::Function::ExternalLinkage, 
+        std::string("Object") + _FUNCTION_PADDING + _INIT, llvm_module.get());
 
     // Declare EXTERNAL Object functions
-    for(auto &method : s->get_clazz("Object").get_children(NodeType::method)) {
+    for(auto &method : s->get_clazz("Object")->get_children(NodeType::method)) {
 
         // Get the formal types
         auto formal_vec = std::vector<llvm::Type *>();
-        formal_vec.push_back(get_llvm_type("Object")); // Add pointer to class instance
+        formal_vec.push_back(get_llvm_type(TypeRef::clazz(0))); // Add pointer to class instance
                                     
         for(auto &formal : method.get_children(NodeType::formal)) {
-            formal_vec.push_back(get_llvm_type(formal.get_data(DataType::type)));
+            formal_vec.push_back(get_llvm_type(formal.get_type_ref()));
         }
 
-        auto f_type = llvm::FunctionType::get(get_llvm_type(method.get_data(DataType::type)), formal_vec, false);
-        llvm::Function::Create(f_type, llvm::Function::ExternalLinkage, std::string("Object") + _FUNCTION_PADDING + 
-            method.get_data(DataType::id), llvm_module.get());
+        auto f_type = llvm::FunctionType::get(get_llvm_type(method.get_type_ref()), formal_vec, false);
+        llvm_methods[&method] = llvm::Function::Create(f_type, llvm::Function::ExternalLinkage, std::string("Object") + 
+            _FUNCTION_PADDING + method.get_data(DataType::id), llvm_module.get());
     } 
 
     // Declare EXTERNAL malloc function
@@ -195,75 +797,53 @@ void build_structures() {
         {llvm::IntegerType::getInt64Ty(* llvm_context)}, false);
     llvm::Function::Create(malloc_type, llvm::Function::ExternalLinkage, _MALLOC, llvm_module.get());
 
-    // Declare EXTERNAL power function
-    auto power_type = llvm::FunctionType::get(llvm::IntegerType::getInt64Ty(* llvm_context), 
-        {get_llvm_type("int32"), get_llvm_type("int32")}, false);
-    llvm::Function::Create(power_type, llvm::Function::ExternalLinkage, _POWER, llvm_module.get());
 
     // Declare all Class functions (except for Object)
     for(auto &clazz : s->get_defined_clazzes()) {
 
-        std::string id = clazz.get_data(DataType::id);
+        std::string id = clazz->get_data(DataType::id);
+        TypeRef type = clazz->get_type_ref();
 
         // Declare 'new' function
-        new_f = llvm::FunctionType::get(get_llvm_type(id), false);
-        llvm_module->getOrInsertFunction(id + _FUNCTION_PADDING + _NEW_, new_f);
+        new_f = llvm::FunctionType::get(get_llvm_type(type), false);
+        llvm_new_functions[type.get_clazz()] = llvm::Function::Create(new_f, llvm::Function::ExternalLinkage, 
+            id + _FUNCTION_PADDING + _NEW_, llvm_module.get());
 
         // Declare 'init' function
-        init_f = llvm::FunctionType::get(get_llvm_type(id), {get_llvm_type(id)}, false);
-        llvm_module->getOrInsertFunction(id + _FUNCTION_PADDING + _INIT, init_f);
+        init_f = llvm::FunctionType::get(get_llvm_type(type), {get_llvm_type(type)}, false);
+        llvm_init_functions[type.get_clazz()] = llvm::Function::Create(init_f, llvm::Function::ExternalLinkage, 
+            id + _FUNCTION_PADDING + _INIT, llvm_module.get());
             
         for(auto &method : s->get_methods_for(id)) {
 
             // Get the formal types
             auto formal_vec = std::vector<llvm::Type *>();
-            formal_vec.push_back(get_llvm_type(id)); // Add pointer to class instance
+            formal_vec.push_back(get_llvm_type(type)); // Add pointer to class instance
                                         
-            for(auto &formal : method.get_children(NodeType::formal)) {
-                formal_vec.push_back(get_llvm_type(formal.get_data(DataType::type)));
+            for(auto &formal : method->get_children(NodeType::formal)) {
+                formal_vec.push_back(get_llvm_type(formal.get_type_ref()));
             }
 
-            auto f = llvm::FunctionType::get(get_llvm_type(method.get_data(DataType::type)), formal_vec, false);
-            llvm_module->getOrInsertFunction(id + _FUNCTION_PADDING + method.get_data(DataType::id), f);
+            auto f = llvm::FunctionType::get(get_llvm_type(method->get_type_ref()), formal_vec, false);
+            llvm_methods[method] = llvm::Function::Create(f, llvm::Function::ExternalLinkage, 
+                id + _FUNCTION_PADDING + method->get_data(DataType::id), llvm_module.get());
+            llvm_methods[method]->setCallingConv(get_calling_conv(s->get_method_slot(id, method->get_data(DataType::id))));
         } 
     }
 
     // For each class, declare the (inherited) method types
+    llvm_vtables.assign(s->get_clazz_count(), nullptr);
     for(auto &clazz : s->get_defined_clazzes(true)) {
-        std::string type = clazz.get_data(DataType::type);
-        llvm::StructType *cur = llvm_module->getTypeByName(type + _VTABLE);
+        std::string type = clazz->get_data(DataType::type);
+        llvm::StructType *cur = llvm_vtable_types[clazz->get_type_ref().get_clazz()];
 
         auto type_vec = std::vector<llvm::Type *>();
         auto method_vec = std::vector<llvm::Constant *>();
 
-        std::map<std::string, bool> overriden;
-        std::map<std::string, int> overriden_index;
-        int index = 0;
-
-        std::vector<std::string> ancestors = s->get_all_ancestors(type);
-        std::reverse(ancestors.begin(), ancestors.end());
-        for(auto &anc : ancestors) {
-            for(auto &method : s->get_clazz(anc).get_children(NodeType::method)) {
-                std::string method_id = method.get_data(DataType::id);
-
-                if(overriden[method_id] == false) { // Not overriding any method
-
-                    method_vec.push_back(llvm_module->getFunction(anc + _FUNCTION_PADDING + method_id));
-                    auto t = ((llvm::Function *)method_vec.back())->getFunctionType();
-                    type_vec.push_back(llvm::PointerType::get(t, 0)); // Pointer to the function definition
-
-                    overriden[method_id] = true;
-                    overriden_index[method_id] = index;
-
-                    method_index_map[type][method_id] = index;
-                
-                } else { // Overriding
-                    method_vec[overriden_index[method_id]] = llvm_module->getFunction(anc + _FUNCTION_PADDING + method_id);
-                    auto t = ((llvm::Function *)method_vec[overriden_index[method_id]])->getFunctionType();
-                    type_vec[overriden_index[method_id]] = llvm::PointerType::get(t, 0); // Pointer to the function definition
-                }
-                ++index;
-            } 
+        for(auto &method : s->get_vtable_layout(type)) {
+            method_vec.push_back(llvm_methods.at(method.decl));
+            auto t = ((llvm::Function *)method_vec.back())->getFunctionType();
+            type_vec.push_back(llvm::PointerType::get(t, 0)); // Pointer to the function definition
         }
         cur->setBody(type_vec);
 
@@ -271,34 +851,34 @@ void build_structures() {
         if(type != "Object") { // Avoid Object global VTABLE redefinition
             auto init = llvm::ConstantStruct::get(cur, method_vec);
             llvm::GlobalVariable *vtable = (llvm::GlobalVariable *)llvm_module->getOrInsertGlobal(type + _VTABLE_PADDING + "vtable", cur);
-            vtable->setInitializer(init);
+            if(clazz->get_type_ref().get_clazz() % partitions == partition) { // Defined by the partition of the clazz only
+                vtable->setInitializer(init);
+            }
             vtable->setConstant(true);
+            llvm_vtables[clazz->get_type_ref().get_clazz()] = vtable;
         } 
     }
 
     // For each class, declare the (inherited) field types
     for(auto &clazz : s->get_defined_clazzes(true)) {
-        std::string type = clazz.get_data(DataType::type);
+        std::string type = clazz->get_data(DataType::type);
 
-        llvm::StructType *cur = (llvm::StructType *) llvm_module->getTypeByName(type);
+        llvm::StructType *cur = llvm_clazz_types[clazz->get_type_ref().get_clazz()];
 
         auto type_vec = std::vector<llvm::Type *>();
-        type_vec.push_back(llvm::PointerType::get(llvm_module->getTypeByName(type + _VTABLE), 0)); // Add table pointer
-
-        std::vector<std::string> ancestors = s->get_all_ancestors(type);
-        std::reverse(ancestors.begin(), ancestors.end());
-        for(auto &anc : ancestors) {
+        type_vec.push_back(llvm::PointerType::get(llvm_vtable_types[clazz->get_type_ref().get_clazz()], 0)); // Add table pointer
 
-            for(auto &field : s->get_fields_for(anc)) {
-                std::string t = field.get_data(DataType::type);
-                type_vec.push_back(get_llvm_type(t));
-            } 
+        for(auto &field : s->get_field_layout(type)) {
+            type_vec.push_back(get_llvm_type(field.decl->get_type_ref()));
         }
         cur->setBody(type_vec);
     }
 
-    // Build 'main' method aka LLVM entry point
-    llvm_module->getOrInsertFunction("main", llvm::FunctionType::get(get_llvm_type("int32"), false));
+    // Build 'main' method aka LLVM entry point, in the first partition only
+    if(partition != 0) {
+        return;
+    }
+    llvm_module->getOrInsertFunction("main", llvm::FunctionType::get(get_llvm_type(TypeRef::int32), false));
     llvm::BasicBlock *main_b = llvm::BasicBlock::Create(* llvm_context, "entry", llvm_module->getFunction("main"));
     llvm_builder->SetInsertPoint(main_b);
 
@@ -308,7 +888,8 @@ void build_structures() {
 
         // Call to 'Main.main()'
     llvm::Function *main_f = llvm_module->getFunction(std::string("Main") + _FUNCTION_PADDING + "main");
-    llvm::Value *main_ret = llvm_builder->CreateCall(main_f, {main_val});
+    llvm::CallInst *main_ret = llvm_builder->CreateCall(main_f, {main_val});
+    main_ret->setCallingConv(main_f->getCallingConv());
 
         // Ret
     llvm_builder->CreateRet(main_ret);
@@ -316,79 +897,91 @@ void build_structures() {
     return;
 }
 
-llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm::Value * > named_value) {
+llvm::Value *codegen(const Node &n, TypeRef cur_clazz, std::map<std::string, llvm::Value * > &named_value) {
     SymbolTable *s = SymbolTable::getInstance();
 
+    // Go on with a new stack segment when the AST is too deep for this one, taking the module along
+    if(StackSegment::is_exhausted()) {
+        llvm::Value *val;
+        ModuleState state;
+        swap_module_state(state);
+        StackSegment::grow([&]() {
+            swap_module_state(state);
+            val = codegen(n, cur_clazz, named_value);
+            swap_module_state(state);
+        });
+        swap_module_state(state);
+        return val;
+    }
+
     switch(n.get_type()) {
         case NodeType::program: {
             for(auto &clazz : n.get_children(NodeType::clazz)) {
-                codegen(clazz);
+                if(clazz.get_type_ref().get_clazz() % partitions != partition) {
+                    continue; // Generated in another partition
+                }
+                codegen(clazz, TypeRef(), named_value);
             }
             return nullptr;
         }
         case NodeType::clazz: {
-            std::string id = n.get_data(DataType::id);
+            TypeRef type = n.get_type_ref();
+            llvm::StructType *clazz_type = llvm_clazz_types[type.get_clazz()];
+            TypeRef parent = n.get_decl()->get_type_ref();
     
             // Define 'new' function
-            auto new_f = llvm_module->getFunction(id + _FUNCTION_PADDING + _NEW_);
+            auto new_f = llvm_new_functions[type.get_clazz()];
             llvm::BasicBlock *new_b = llvm::BasicBlock::Create(* llvm_context, "entry", (llvm::Function *) new_f);
             llvm_builder->SetInsertPoint(new_b);
 
                 // Malloc call
             auto malloc_f = llvm_module->getFunction(_MALLOC);
-            size_t size = (new llvm::DataLayout(llvm_module.get()))->getTypeAllocSizeInBits(llvm_module->getTypeByName(id));
+            uint64_t size = llvm_module->getDataLayout().getTypeAllocSize(clazz_type).getFixedSize(); // In bytes
             std::vector<llvm::Value * > malloc_args = {llvm::ConstantInt::get(llvm::IntegerType::getInt64Ty(* llvm_context), size)};
             auto self = llvm_builder->CreateCall(malloc_f, malloc_args);
             
                 // Cast to Parent*
-            std::string parent = n.get_data(DataType::parent_id);
-            auto parent_ptr = llvm_builder->CreatePointerCast(self, llvm::PointerType::get(llvm_module->getTypeByName(parent), 0));
+            auto parent_ptr = llvm_builder->CreatePointerCast(self, get_llvm_type(parent));
             
                 // Init call of the inherited classes
-            auto parent_init = llvm_module->getFunction(parent + _FUNCTION_PADDING + _INIT);
-            parent_ptr = llvm_builder->CreateCall((llvm::Function *)parent_init, {parent_ptr});
+            auto parent_init = llvm_init_functions[parent.get_clazz()];
+            parent_ptr = llvm_builder->CreateCall(parent_init, {parent_ptr});
 
                 // Cast to Child*
-            auto child_ptr = llvm_builder->CreatePointerCast(parent_ptr, llvm::PointerType::get(llvm_module->getTypeByName(id), 0));
+            auto child_ptr = llvm_builder->CreatePointerCast(parent_ptr, get_llvm_type(type));
 
-            auto child_init = llvm_module->getFunction(id + _FUNCTION_PADDING + _INIT);
-            child_ptr = llvm_builder->CreateCall((llvm::Function *)child_init, {child_ptr});
+            auto child_init = llvm_init_functions[type.get_clazz()];
+            child_ptr = llvm_builder->CreateCall(child_init, {child_ptr});
             
                 // Ret
             llvm_builder->CreateRet(child_ptr);
 
             // Define 'init' function
-            auto init_f = llvm_module->getFunction(id + _FUNCTION_PADDING + _INIT);
-            llvm::BasicBlock *init_b = llvm::BasicBlock::Create(* llvm_context, "entry", (llvm::Function *) init_f);
+            auto init_f = llvm_init_functions[type.get_clazz()];
+            llvm::BasicBlock *init_b = llvm::BasicBlock::Create(* llvm_context, "entry", init_f);
             llvm_builder->SetInsertPoint(init_b);
 
                 // Set vtable
             auto self_ptr = init_f->args().begin();
-            auto vtable_adr = llvm_builder->CreateStructGEP(llvm_module->getTypeByName(id), self_ptr, 0);
-            llvm_builder->CreateStore(llvm_module->getNamedGlobal(id + _VTABLE_PADDING + "vtable"), vtable_adr);
+            llvm_self = self_ptr;
+            auto vtable_adr = llvm_builder->CreateStructGEP(clazz_type, self_ptr, 0);
+            llvm_builder->CreateStore(llvm_vtables[type.get_clazz()], vtable_adr);
 
                 // Set all other fields
-            std::vector<std::string> ancestors = s->get_all_ancestors(id);
-            std::reverse(ancestors.begin(), ancestors.end());
             int field_index = 1; // 1 to skip the vtable
-            for(auto &anc : ancestors) {
-                for(auto &field : s->get_fields_for(anc)) {
-
-                    llvm::Value *f_val = codegen(field, id);
-                    auto f_addr = llvm_builder->CreateStructGEP(llvm_module->getTypeByName(id), self_ptr, field_index);
-                    llvm_builder->CreateStore(f_val, f_addr);
+            for(auto &member : s->get_field_layout(n.get_data(DataType::id))) {
+                llvm::Value *f_val = codegen(*member.decl, type, named_value);
+                auto f_addr = llvm_builder->CreateStructGEP(clazz_type, self_ptr, field_index);
+                llvm_builder->CreateStore(f_val, f_addr);
 
-                    field_index_map[id][field.get_data(DataType::id)] = field_index;
-
-                    field_index++;
-                }
+                field_index++;
             }
                 // Ret
             llvm_builder->CreateRet(self_ptr);
 
             // Method code generation
             for(auto &method : n.get_children(NodeType::method)) {
-                codegen(method, id);
+                codegen(method, type, named_value);
             }
             
             return nullptr;
@@ -398,46 +991,72 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
 
             if(n.get_children(NodeType::any_expr).empty()) {
                 // Default initialization
-                std::string type = n.get_data(DataType::type);
+                TypeRef type = n.get_type_ref();
                 llvm::Type *f_type = get_llvm_type(type);
 
-                if(type == "int32" || type == "bool") {
+                if(type == TypeRef::int32 || type == TypeRef::boolean) {
                     f_val = llvm::ConstantInt::get(f_type, 0);
-                } else if(type == "string") {
-                    f_val = llvm_builder->CreateGlobalStringPtr("");
+                } else if(type == TypeRef::string) {
+                    f_val = get_string("");
                 } else { // Class ref of Unit
                     f_val = llvm::ConstantPointerNull::get((llvm::PointerType *) f_type);
                 }
             } else {
-                f_val = codegen(*n.get_children(NodeType::any_expr).begin());
+                f_val = codegen(*n.get_children(NodeType::any_expr).begin(), TypeRef(), named_value);
             }
 
             return f_val;
         }
         case NodeType::method: {
-            llvm::Function *method = llvm_module->getFunction(clazz_name + _FUNCTION_PADDING + n.get_data(DataType::id));
-            llvm::BasicBlock *method_b = llvm::BasicBlock::Create(* llvm_context, "entry", (llvm::Function *) method);
+            llvm::Function *method = llvm_methods.at(&n);
+            llvm::BasicBlock *method_b = llvm::BasicBlock::Create(* llvm_context, "entry", method);
             llvm_builder->SetInsertPoint(method_b);
 
             auto arg = method->args().begin();
+            llvm_self = arg;
             arg++;
+            llvm_formals.clear();
             for(auto &formal : n.get_children(NodeType::formal)) {
-                llvm::Value* formal_val = llvm_builder->CreateAlloca(get_llvm_type(formal.get_data(DataType::type)));
+                llvm::Value* formal_val = create_entry_alloca(get_llvm_type(formal.get_type_ref()), formal.get_data(DataType::id));
                 llvm_builder->CreateStore(arg, formal_val);
                 named_value[formal.get_data(DataType::id)] = formal_val;
+                llvm_formals.push_back(formal_val);
                 ++arg;
             }
 
-            auto ret_val = codegen(*n.get_children(NodeType::block).begin(), clazz_name, named_value);
+            // A self-recursive call in tail position loops back here, with its own receiver
+            const Node &body = *n.get_children(NodeType::block).begin();
+            find_tail_calls(body, tail_calls);
+            tail_loop = nullptr;
+            for(auto call : tail_calls) {
+                const Node &parent = *call->get_children(NodeType::parent_statement).begin();
+                if(s->get_single_implementation(parent.get_type_ref(), call->get_slot()) == &n) {
+                    tail_loop = llvm::BasicBlock::Create(* llvm_context, "tailrecurse", method);
+                    llvm_builder->CreateBr(tail_loop);
+                    llvm_builder->SetInsertPoint(tail_loop);
+                    tail_self = llvm_builder->CreatePHI(llvm_self->getType(), 2, "self");
+                    tail_self->addIncoming(llvm_self, method_b);
+                    llvm_self = tail_self;
+                    break;
+                }
+            }
+
+            auto ret_val = codegen(body, cur_clazz, named_value);
+            tail_calls.clear();
 
             llvm_builder->CreateRet(ret_val);
 
+            // The formals go out of scope
+            for(auto &formal : n.get_children(NodeType::formal)) {
+                named_value.erase(formal.get_data(DataType::id));
+            }
+
             return nullptr;
         }
         case NodeType::block: {
             llvm::Value *val;
             for(auto &expr : n.get_children(NodeType::any_expr)) {
-                val = codegen(expr, clazz_name, named_value);
+                val = codegen(expr, cur_clazz, named_value);
             }
             return val;
         }
@@ -445,7 +1064,7 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
             llvm::Function *cur_f = llvm_builder->GetInsertBlock()->getParent(); 
 
             // Generate the conditionnal code
-            llvm::Value *cond_val = codegen(*n.get_children(NodeType::if_statement).begin(), clazz_name, named_value);
+            llvm::Value *cond_val = codegen(*n.get_children(NodeType::if_statement).begin(), cur_clazz, named_value);
 
             // Create the blocks
             llvm::BasicBlock *then_b = llvm::BasicBlock::Create(* llvm_context, "if.then");
@@ -455,13 +1074,13 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
             // Create a conditional branch
             llvm_builder->CreateCondBr(cond_val, then_b, else_b);
 
-            llvm::Type *cast_type = get_llvm_type(n.get_data(DataType::type));
+            llvm::Type *cast_type = get_llvm_type(n.get_type_ref());
 
             // THEN Block 
             cur_f->getBasicBlockList().push_back(then_b); // Append the then block
 
             llvm_builder->SetInsertPoint(then_b);
-            llvm::Value *then_val = codegen(*n.get_children(NodeType::then_statement).begin(), clazz_name, named_value);
+            llvm::Value *then_val = codegen(*n.get_children(NodeType::then_statement).begin(), cur_clazz, named_value);
             then_val = llvm_builder->CreatePointerCast(then_val, cast_type);
             llvm_builder->CreateBr(end_b);
 
@@ -471,9 +1090,9 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
             cur_f->getBasicBlockList().push_back(else_b); // Append the else block
 
             llvm_builder->SetInsertPoint(else_b);
-            llvm::Value *else_val = llvm::ConstantPointerNull::get((llvm::PointerType *)get_llvm_type("unit"));
+            llvm::Value *else_val = llvm::ConstantPointerNull::get((llvm::PointerType *)get_llvm_type(TypeRef::unit));
             if(!n.get_children(NodeType::else_statement).empty()) {
-                else_val = codegen(*n.get_children(NodeType::else_statement).begin(), clazz_name, named_value);
+                else_val = codegen(*n.get_children(NodeType::else_statement).begin(), cur_clazz, named_value);
             }
             else_val = llvm_builder->CreatePointerCast(else_val, cast_type);
             llvm_builder->CreateBr(end_b);
@@ -503,12 +1122,12 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
 
             // COND Block
             llvm_builder->SetInsertPoint(cond_b);
-            llvm::Value *cond_val = codegen(*n.get_children(NodeType::while_statement).begin(), clazz_name, named_value);
+            llvm::Value *cond_val = codegen(*n.get_children(NodeType::while_statement).begin(), cur_clazz, named_value);
             llvm_builder->CreateCondBr(cond_val, body_b, end_b);
 
             // BODY Block
             llvm_builder->SetInsertPoint(body_b);
-            codegen(*n.get_children(NodeType::do_statement).begin(), clazz_name, named_value);
+            codegen(*n.get_children(NodeType::do_statement).begin(), cur_clazz, named_value);
             llvm_builder->CreateBr(cond_b);
 
             // End Block
@@ -516,63 +1135,70 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
             return nullptr;
         }
         case NodeType::let_expr: {
-            // Allocate the new variable
-            std::string init_type = n.get_children(NodeType::object_identifier).begin()->get_data(DataType::type);
-            llvm::Value *let_val = llvm_builder->CreateAlloca(get_llvm_type(init_type));
+            // Allocate the new variable in the entry block, its lifetime starting here
+            TypeRef init_type = n.get_children(NodeType::object_identifier).begin()->get_type_ref();
+            std::string id = n.get_children(NodeType::object_identifier).begin()->get_data(DataType::literal_value);
+            llvm::Value *let_val = create_entry_alloca(get_llvm_type(init_type), id);
+            llvm::ConstantInt *let_size = llvm_builder->getInt64(llvm_module->getDataLayout().getTypeAllocSize(get_llvm_type(init_type)).getFixedSize());
         
             // Initialize it
             llvm::Value *init_val;
             if(n.get_children(NodeType::init_statement).empty()) {
                 // Default initialization
                 llvm::Type *f_type = get_llvm_type(init_type);
-                if(init_type == "int32" || init_type == "bool") {
+                if(init_type == TypeRef::int32 || init_type == TypeRef::boolean) {
                     init_val = llvm::ConstantInt::get(f_type, 0);
-                } else if(init_type == "string") {
-                    init_val = llvm_builder->CreateGlobalStringPtr("");
+                } else if(init_type == TypeRef::string) {
+                    init_val = get_string("");
                 } else { // Class ref of Unit
                     init_val = llvm::ConstantPointerNull::get((llvm::PointerType *) f_type);
                 }
             } else {
                 // Generate the initialization
-                init_val = codegen(*n.get_children(NodeType::init_statement).begin(), clazz_name, named_value);
+                init_val = codegen(*n.get_children(NodeType::init_statement).begin(), cur_clazz, named_value);
                 
                 // Cast if needed
                 init_val = llvm_builder->CreatePointerCast(init_val, get_llvm_type(init_type));
             }
 
             // Store the initial value
+            llvm_builder->CreateLifetimeStart(let_val, let_size);
             llvm_builder->CreateStore(init_val, let_val);
 
-            // Add to scope
-            std::string id = n.get_children(NodeType::object_identifier).begin()->get_data(DataType::literal_value);
+            // Add to scope, shadowing the outer variable (if any)
+            auto outer = named_value.find(id);
+            llvm::Value *outer_val = (outer == named_value.end()) ? nullptr : outer->second;
             named_value[id] = let_val;
 
             // Generate the body code
-            llvm::Value *scope_val = codegen(*n.get_children(NodeType::scope_statement).begin(), clazz_name, named_value);
-            
+            live_lets.emplace_back(let_val, let_size);
+            llvm::Value *scope_val = codegen(*n.get_children(NodeType::scope_statement).begin(), cur_clazz, named_value);
+            live_lets.pop_back();
+            llvm_builder->CreateLifetimeEnd(let_val, let_size);
+
+            // Restore the outer variable
+            if(outer_val != nullptr) {
+                named_value[id] = outer_val;
+            } else {
+                named_value.erase(id);
+            }
             return scope_val;
         }
         case NodeType::assign_expr: {
             // Generate the code to be assigned
-            llvm::Value *val = codegen(*n.get_children(NodeType::any_expr).begin(), clazz_name, named_value);
+            llvm::Value *val = codegen(*n.get_children(NodeType::any_expr).begin(), cur_clazz, named_value);
 
             // Cast the value
-            std::string cast_type = n.get_data(DataType::type);
-            val = llvm_builder->CreatePointerCast(val, get_llvm_type(cast_type));
+            val = llvm_builder->CreatePointerCast(val, get_llvm_type(n.get_type_ref()));
 
-            std::string id = n.get_data(DataType::id);
-            if(named_value[id] == nullptr) { // class variable
+            if(n.get_decl() != nullptr) { // class variable, resolved by the checker
 
-                // Get the pointer to the current class
-                llvm::Function *cur_f = llvm_builder->GetInsertBlock()->getParent();
-                auto clazz = cur_f->args().begin();
-                
                 // Save the result
-                auto f_addr = llvm_builder->CreateStructGEP(llvm_module->getTypeByName(clazz_name), clazz, field_index_map[clazz_name][id]);
+                auto f_addr = llvm_builder->CreateStructGEP(llvm_clazz_types[cur_clazz.get_clazz()], llvm_self, n.get_slot());
                 llvm_builder->CreateStore(val, f_addr);
 
             } else { // local variable
-                llvm_builder->CreateStore(val, named_value[id]);
+                llvm_builder->CreateStore(val, named_value[n.get_data(DataType::id)]);
             }
 
             return val;
@@ -580,7 +1206,7 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
         case NodeType::unop_expr: {
             std::string op = n.get_data(DataType::op);
 
-            llvm::Value *right = codegen(*n.get_children(NodeType::any_expr).begin(), clazz_name, named_value);
+            llvm::Value *right = codegen(*n.get_children(NodeType::any_expr).begin(), cur_clazz, named_value);
             llvm::Value *ret;
             if(op == "-") {
                 ret = llvm_builder->CreateNeg(right);
@@ -597,7 +1223,7 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
             std::string op = n.get_data(DataType::op);
 
             // Generate code for LEFT
-            llvm::Value *left = codegen(*n.get_children(NodeType::left_statement).begin(), clazz_name, named_value);
+            llvm::Value *left = codegen(*n.get_children(NodeType::left_statement).begin(), cur_clazz, named_value);
 
             if(op == "and") {
 
@@ -612,7 +1238,7 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
                 llvm_builder->GetInsertBlock()->getParent()->getBasicBlockList().push_back(left_eval_true);
 
                 llvm_builder->SetInsertPoint(left_eval_true);
-                llvm::Value *true_ret = codegen(*n.get_children(NodeType::right_statement).begin(), clazz_name, named_value);
+                llvm::Value *true_ret = codegen(*n.get_children(NodeType::right_statement).begin(), cur_clazz, named_value);
                 llvm_builder->CreateBr(end);
 
                 left_eval_true = llvm_builder->GetInsertBlock();
@@ -630,7 +1256,7 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
                 llvm_builder->GetInsertBlock()->getParent()->getBasicBlockList().push_back(end);
                 llvm_builder->SetInsertPoint(end);
 
-                llvm::Value *ret = llvm_builder->CreatePHI(get_llvm_type("bool"), 0);
+                llvm::Value *ret = llvm_builder->CreatePHI(get_llvm_type(TypeRef::boolean), 0);
                 ((llvm::PHINode *)ret)->addIncoming(true_ret, left_eval_true);
                 ((llvm::PHINode *)ret)->addIncoming(false_ret, left_eval_false);
 
@@ -638,11 +1264,11 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
 
             } else {
                 // Generate code for RIGHT
-                llvm::Value *right = codegen(*n.get_children(NodeType::right_statement).begin(), clazz_name, named_value);
+                llvm::Value *right = codegen(*n.get_children(NodeType::right_statement).begin(), cur_clazz, named_value);
 
                 if(op == "=") {
                     // If comparing classes, cast the addresses to interger and compare
-                    if(s->is_defined_clazz(n.get_children(NodeType::left_statement).begin()->get_data(DataType::type))) {
+                    if(n.get_children(NodeType::left_statement).begin()->get_type_ref().is_clazz()) {
                         left = llvm_builder->CreatePointerCast(left, llvm::IntegerType::getInt64Ty(* llvm_context));
                         right = llvm_builder->CreatePointerCast(right, llvm::IntegerType::getInt64Ty(* llvm_context));
                     }
@@ -667,8 +1293,7 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
                     return llvm_builder->CreateUDiv(left, right);
 
                 } else if(op == "^") {
-                    llvm::Value *ret = llvm_builder->CreateCall(llvm_module->getFunction(_POWER), {left, right});
-                    return llvm_builder->CreateIntCast(ret, get_llvm_type("int32"), true);
+                    return build_power(left, right);
                 } else {
                     return nullptr;
                 }
@@ -678,29 +1303,47 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
             
             llvm::Value *vtable;
             llvm::Argument *clazz;
-            std::string name;
-            Node parent = *n.get_children(NodeType::parent_statement).begin();
-
-            clazz = (llvm::Argument *) codegen(*n.get_children(NodeType::parent_statement).begin(), clazz_name, named_value); 
-            if(parent.get_data(DataType::literal_value) == "self") {
-                name = clazz_name;
+            const Node &parent = *n.get_children(NodeType::parent_statement).begin();
+            int receiver = parent.get_type_ref().get_clazz(); // Static clazz of the receiver
+
+            clazz = (llvm::Argument *) codegen(parent, cur_clazz, named_value); 
+            ++call_sites;
+
+            llvm::Value *f;
+            llvm::FunctionType *f_type;
+            llvm::GlobalVariable *guess = nullptr; // The vtable of the clazz speculated by the profile, if any
+            llvm::Function *guess_f = nullptr; // The implementation of the method for that clazz
+            const Node *target = s->get_single_implementation(parent.get_type_ref(), n.get_slot());
+            if(target != nullptr) {
+                // Only one implementation is reachable from the static clazz, call it directly
+                f = llvm_methods.at(target);
+                f_type = ((llvm::Function *) f)->getFunctionType();
+                ++devirtualized_calls;
             } else {
-                name = parent.get_data(DataType::type);
+                // Fetch the VTABLE
+                vtable = llvm_builder->CreateStructGEP(llvm_clazz_types[receiver], clazz, 0);
+                vtable = llvm_builder->CreateLoad(vtable);
+                
+                // Fetch the function at the slot resolved by the checker
+                int method_index = n.get_slot();
+                llvm::Type *struct_type = llvm_vtable_types[receiver];
+                f = llvm_builder->CreateStructGEP(struct_type, vtable, method_index);
+                f = llvm_builder->CreateLoad(f);
+                f_type = (llvm::FunctionType *)((llvm::PointerType *) struct_type->getStructElementType(method_index))->getElementType();
+
+                // Count the receiver clazzes, or speculate on the hottest one
+                int site = polymorphic_sites++;
+                if(!profile_output.empty()) {
+                    instrument_site(site, parent.get_type_ref(), vtable);
+                }
+                TypeRef hot = get_hot_clazz(site, parent.get_type_ref());
+                if(hot.is_clazz()) {
+                    guess = llvm_vtables[hot.get_clazz()];
+                    guess_f = llvm_methods.at(s->get_vtable_layout(s->get_type_name(hot))[method_index].decl);
+                }
             }
-            
-            // Fetch the VTABLE
-            vtable = llvm_builder->CreateStructGEP(llvm_module->getTypeByName(name), clazz, 0);
-            vtable = llvm_builder->CreateLoad(vtable);
-            
-            // Fetch the function
-            std::string method_id = n.get_data(DataType::id);
-            int method_index = method_index_map[name][method_id];
-            llvm::Type *struct_type = llvm_module->getTypeByName(name + _VTABLE);
-            llvm::Value *f = llvm_builder->CreateStructGEP(struct_type, vtable, method_index);
-            f = llvm_builder->CreateLoad(f);
 
             // Cast the class pointer
-            llvm::FunctionType *f_type = (llvm::FunctionType *)((llvm::PointerType *) struct_type->getStructElementType(method_index))->getElementType();
             llvm::Type *cast_type = f_type->getParamType(0);
             clazz = (llvm::Argument *)llvm_builder->CreatePointerCast(clazz, cast_type);
 
@@ -710,7 +1353,7 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
             int i = 1;
             for(auto &arg : n.get_children(NodeType::args)) {
                 // Generate the ARG code
-                llvm::Value *arg_val = codegen(arg, clazz_name, named_value);
+                llvm::Value *arg_val = codegen(arg, cur_clazz, named_value);
 
                 // Cast
                 arg_val = llvm_builder->CreatePointerCast(arg_val, f_type->getParamType(i));
@@ -720,27 +1363,64 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
             }
 
             // Call the function
-            llvm::Value *f_call = llvm_builder->CreateCall(f_type, f, args);
+            llvm::CallingConv::ID calling_conv = get_calling_conv(n.get_slot());
+            if(guess == nullptr && tail_calls.count(&n) != 0) {
+                return build_tail_call(n, f_type, f, args);
+            }
+            if(guess == nullptr) {
+                llvm::CallInst *call = llvm_builder->CreateCall(f_type, f, args);
+                call->setCallingConv(calling_conv);
+                return call;
+            }
+
+            // Compare the vtable with the speculated one, to call its implementation directly on a match
+            llvm::Function *cur_f = llvm_builder->GetInsertBlock()->getParent();
+            llvm::BasicBlock *direct_b = llvm::BasicBlock::Create(* llvm_context, "speculated", cur_f);
+            llvm::BasicBlock *indirect_b = llvm::BasicBlock::Create(* llvm_context, "virtual", cur_f);
+            llvm::BasicBlock *merge_b = llvm::BasicBlock::Create(* llvm_context, "dispatched", cur_f);
+
+            llvm::Value *hit = llvm_builder->CreateICmpEQ(llvm_builder->CreatePointerCast(vtable, guess->getType()), guess);
+            llvm_builder->CreateCondBr(hit, direct_b, indirect_b);
+            ++speculated_calls;
+
+                // Direct call
+            llvm_builder->SetInsertPoint(direct_b);
+            std::vector<llvm::Value * > direct_args;
+            for(size_t k = 0; k < args.size(); ++k) {
+                direct_args.push_back(llvm_builder->CreatePointerCast(args[k], guess_f->getFunctionType()->getParamType(k)));
+            }
+            llvm::CallInst *guess_call = llvm_builder->CreateCall(guess_f, direct_args);
+            guess_call->setCallingConv(calling_conv);
+            llvm::Value *direct_call = llvm_builder->CreatePointerCast(guess_call, f_type->getReturnType());
+            direct_b = llvm_builder->GetInsertBlock();
+            llvm_builder->CreateBr(merge_b);
+
+                // Indirect call
+            llvm_builder->SetInsertPoint(indirect_b);
+            llvm::CallInst *indirect_call = llvm_builder->CreateCall(f_type, f, args);
+            indirect_call->setCallingConv(calling_conv);
+            llvm_builder->CreateBr(merge_b);
+
+                // Merge
+            llvm_builder->SetInsertPoint(merge_b);
+            llvm::PHINode *f_call = llvm_builder->CreatePHI(f_type->getReturnType(), 2);
+            f_call->addIncoming(direct_call, direct_b);
+            f_call->addIncoming(indirect_call, indirect_b);
 
             return f_call;
         }
         case NodeType::new_expr: {
-            std::string type = n.get_data(DataType::type);
-            return llvm_builder->CreateCall(llvm_module->getFunction(type + _FUNCTION_PADDING + _NEW_));
+            return llvm_builder->CreateCall(llvm_new_functions[n.get_type_ref().get_clazz()]);
         }
         case NodeType::object_identifier: {
             std::string id = n.get_data(DataType::literal_value);     
             llvm::Value *val;
-            if(named_value[id] == nullptr) { // class variable
+            if(n.get_decl() != nullptr || id == "self") { // class variable, resolved by the checker
 
-                // Get the pointer to the current class
-                llvm::Function *cur_f = llvm_builder->GetInsertBlock()->getParent();
-                auto clazz = cur_f->args().begin();
-                
                 if(id != "self") {
-                    val = llvm_builder->CreateStructGEP(llvm_module->getTypeByName(clazz_name), clazz, field_index_map[clazz_name][id]);
+                    val = llvm_builder->CreateStructGEP(llvm_clazz_types[cur_clazz.get_clazz()], llvm_self, n.get_slot());
                 } else {
-                    return clazz;
+                    return llvm_self;
                 }
 
             } else { // local variable
@@ -750,24 +1430,24 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
         }
         case NodeType::literal_int32: {
             int val = std::stoi(n.get_data(DataType::literal_value));
-            return llvm::ConstantInt::get(get_llvm_type("int32"), val);
+            return llvm::ConstantInt::get(get_llvm_type(TypeRef::int32), val);
         }
         case NodeType::literal_bool: {
             std::string val = n.get_data(DataType::literal_value);
             if(val == "true") {
-                return llvm::ConstantInt::get(get_llvm_type("bool"), 1);
+                return llvm::ConstantInt::get(get_llvm_type(TypeRef::boolean), 1);
             } else {
-                return llvm::ConstantInt::get(get_llvm_type("bool"), 0);
+                return llvm::ConstantInt::get(get_llvm_type(TypeRef::boolean), 0);
             }
         }
         case NodeType::literal_string: {
             std::string formated = std::string(n.get_data(DataType::literal_value));
             format_string(formated);
 
-            return llvm_builder->CreateGlobalStringPtr(formated);
+            return get_string(formated);
         }
         case NodeType::literal_unit: {
-            return llvm::ConstantPointerNull::get((llvm::PointerType *) get_llvm_type("unit"));
+            return llvm::ConstantPointerNull::get((llvm::PointerType *) get_llvm_type(TypeRef::unit));
         }
         default: {
             return nullptr;
@@ -775,18 +1455,328 @@ llvm::Value *codegen(Node &n, std::string clazz_name, std::map<std::string, llvm
     }
 }
 
-llvm::Type *get_llvm_type(std::string type) {
+llvm::Constant *get_string(const std::string &str) {
+    auto pooled = string_pool.find(str);
+    if(pooled != string_pool.end()) {
+        return pooled->second;
+    }
+
+    llvm::Constant *data = llvm::ConstantDataArray::getString(* llvm_context, str);
+    auto literal = new llvm::GlobalVariable(* llvm_module, data->getType(), true, llvm::GlobalValue::PrivateLinkage, data);
+    literal->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    literal->setAlignment(llvm::MaybeAlign(1));
+
+    llvm::Constant *zero = llvm::ConstantInt::get(llvm::IntegerType::getInt32Ty(* llvm_context), 0);
+    llvm::Constant *ptr = llvm::ConstantExpr::getInBoundsGetElementPtr(data->getType(), literal, llvm::ArrayRef<llvm::Constant *>({zero, zero}));
+    string_pool[str] = ptr;
+    return ptr;
+}
+
+llvm::AllocaInst *create_entry_alloca(llvm::Type *type, const std::string &name) {
+    llvm::BasicBlock &entry = llvm_builder->GetInsertBlock()->getParent()->getEntryBlock();
+    llvm::IRBuilder<> entry_builder(&entry, entry.begin());
+    return entry_builder.CreateAlloca(type, nullptr, name);
+}
+
+void find_tail_calls(const Node &n, std::set<const Node *> &calls) {
+    switch(n.get_type()) {
+        case NodeType::block: {
+            const Node *last = nullptr;
+            for(auto &expr : n.get_children(NodeType::any_expr)) {
+                last = &expr;
+            }
+            if(last != nullptr) {
+                find_tail_calls(*last, calls);
+            }
+            return;
+        }
+        case NodeType::if_expr: {
+            for(auto &branch : n.get_children(NodeType::then_statement)) {
+                find_tail_calls(branch, calls);
+            }
+            for(auto &branch : n.get_children(NodeType::else_statement)) {
+                find_tail_calls(branch, calls);
+            }
+            return;
+        }
+        case NodeType::let_expr: {
+            find_tail_calls(*n.get_children(NodeType::scope_statement).begin(), calls);
+            return;
+        }
+        case NodeType::call_expr: {
+            calls.insert(&n);
+            return;
+        }
+        default: {
+            return;
+        }
+    }
+}
+
+llvm::Value *build_tail_call(const Node &n, llvm::FunctionType *f_type, llvm::Value *f, std::vector<llvm::Value * > &args) {
+    llvm::Function *cur_f = llvm_builder->GetInsertBlock()->getParent();
+    llvm::FunctionType *cur_type = cur_f->getFunctionType();
+
+    // The let variables in scope end with the method
+    for(auto &let : live_lets) {
+        llvm_builder->CreateLifetimeEnd(let.first, let.second);
+    }
+
+    std::string outcome;
+    if(f == cur_f && tail_loop != nullptr) {
+        // Next iteration, the formals being only overwritten once all the arguments are evaluated
+        for(size_t k = 1; k < args.size(); ++k) {
+            llvm_builder->CreateStore(args[k], llvm_formals[k - 1]);
+        }
+        llvm::Value *self = llvm_builder->CreatePointerCast(args[0], tail_self->getType());
+        tail_self->addIncoming(self, llvm_builder->GetInsertBlock());
+        llvm_builder->CreateBr(tail_loop);
+        ++looped_calls;
+        outcome = "turned into a loop";
+    } else {
+        // Only pointers may differ between the prototypes of a guaranteed tail call, which share a calling convention
+        llvm::CallingConv::ID calling_conv = get_calling_conv(n.get_slot());
+        auto same_kind = [](llvm::Type *a, llvm::Type *b) { return a == b || (a->isPointerTy() && b->isPointerTy()); };
+        bool matching = calling_conv == cur_f->getCallingConv() && f_type->getNumParams() == cur_type->getNumParams() 
+            && same_kind(f_type->getReturnType(), cur_type->getReturnType());
+        for(unsigned k = 0; matching && k < f_type->getNumParams(); ++k) {
+            matching = same_kind(f_type->getParamType(k), cur_type->getParamType(k));
+        }
+
+        llvm::CallInst *call = llvm_builder->CreateCall(f_type, f, args);
+        call->setCallingConv(calling_conv);
+        if(matching) {
+            call->setTailCallKind(llvm::CallInst::TCK_MustTail);
+            ++guaranteed_calls;
+            outcome = "guaranteed (musttail)";
+        } else {
+            call->setTailCallKind(llvm::CallInst::TCK_Tail);
+            ++hinted_calls;
+            outcome = "marked tail";
+        }
+        llvm_builder->CreateRet(llvm_builder->CreatePointerCast(call, cur_type->getReturnType()));
+    }
+
+    if(report_tail) {
+        std::lock_guard<std::mutex> lock(report_mutex);
+        tail_report.emplace_back(n.get_line(), n.get_column(), "tail call to " + n.get_data(DataType::id) + " " + outcome);
+    }
+
+    // The code of the enclosing expressions is left in a block without predecessors
+    llvm::BasicBlock *dead_b = llvm::BasicBlock::Create(* llvm_context, "tail.dead", cur_f);
+    llvm_builder->SetInsertPoint(dead_b);
+    return llvm::UndefValue::get(f_type->getReturnType());
+}
+
+llvm::Value *build_power(llvm::Value *x, llvm::Value *y) {
+    llvm::Type *int_type = get_llvm_type(TypeRef::int32);
+    llvm::Value *one = llvm::ConstantInt::get(int_type, 1);
+    llvm::Value *zero = llvm::ConstantInt::get(int_type, 0);
+    auto constant_x = llvm::dyn_cast<llvm::ConstantInt>(x);
+    auto constant_y = llvm::dyn_cast<llvm::ConstantInt>(y);
+
+    // Fold constant operands
+    if(constant_x != nullptr && constant_y != nullptr) {
+        int32_t base = (int32_t) constant_x->getSExtValue();
+        int32_t exponent = (int32_t) constant_y->getSExtValue();
+        uint32_t result = 1;
+        uint32_t square = (uint32_t) base;
+        for(uint32_t e = exponent < 0 ? 0u - (uint32_t) exponent : (uint32_t) exponent; e != 0; e >>= 1) {
+            if(e & 1) {
+                result *= square;
+            }
+            square *= square;
+        }
+        if(exponent < 0 && base != 1 && base != -1) {
+            result = 0;
+        }
+        return llvm::ConstantInt::get(int_type, (int32_t) result, true);
+    }
+
+    llvm::Value *result = one;
+    llvm::Value *negative = nullptr; // Whether the exponent is negative, nullptr if known not to be
+    if(constant_y != nullptr) {
+        // Unroll the squarings for a constant exponent
+        int32_t exponent = (int32_t) constant_y->getSExtValue();
+        llvm::Value *square = x;
+        bool first = true;
+        for(uint32_t e = exponent < 0 ? 0u - (uint32_t) exponent : (uint32_t) exponent; e != 0; e >>= 1) {
+            if(e & 1) {
+                result = first ? square : llvm_builder->CreateMul(result, square);
+                first = false;
+            }
+            if(e > 1) {
+                square = llvm_builder->CreateMul(square, square);
+            }
+        }
+        if(exponent < 0) {
+            negative = llvm_builder->getTrue();
+        }
+    } else {
+        // Loop over the bits of |y|
+        negative = llvm_builder->CreateICmpSLT(y, zero);
+        llvm::Value *exponent = llvm_builder->CreateSelect(negative, llvm_builder->CreateNeg(y), y);
+
+        llvm::Function *cur_f = llvm_builder->GetInsertBlock()->getParent();
+        llvm::BasicBlock *entry_b = llvm_builder->GetInsertBlock();
+        llvm::BasicBlock *loop_b = llvm::BasicBlock::Create(* llvm_context, "pow.loop", cur_f);
+        llvm::BasicBlock *body_b = llvm::BasicBlock::Create(* llvm_context, "pow.body", cur_f);
+        llvm::BasicBlock *done_b = llvm::BasicBlock::Create(* llvm_context, "pow.done", cur_f);
+        llvm_builder->CreateBr(loop_b);
+
+        llvm_builder->SetInsertPoint(loop_b);
+        llvm::PHINode *cur_result = llvm_builder->CreatePHI(int_type, 2);
+        llvm::PHINode *cur_square = llvm_builder->CreatePHI(int_type, 2);
+        llvm::PHINode *cur_exponent = llvm_builder->CreatePHI(int_type, 2);
+        llvm_builder->CreateCondBr(llvm_builder->CreateICmpNE(cur_exponent, zero), body_b, done_b);
+
+        llvm_builder->SetInsertPoint(body_b);
+        llvm::Value *odd = llvm_builder->CreateICmpNE(llvm_builder->CreateAnd(cur_exponent, one), zero);
+        llvm::Value *next_result = llvm_builder->CreateSelect(odd, llvm_builder->CreateMul(cur_result, cur_square), cur_result);
+        llvm::Value *next_square = llvm_builder->CreateMul(cur_square, cur_square);
+        llvm::Value *next_exponent = llvm_builder->CreateLShr(cur_exponent, one);
+        llvm_builder->CreateBr(loop_b);
+
+        cur_result->addIncoming(one, entry_b);
+        cur_result->addIncoming(next_result, body_b);
+        cur_square->addIncoming(x, entry_b);
+        cur_square->addIncoming(next_square, body_b);
+        cur_exponent->addIncoming(exponent, entry_b);
+        cur_exponent->addIncoming(next_exponent, body_b);
+
+        llvm_builder->SetInsertPoint(done_b);
+        result = cur_result;
+    }
+
+    // 1/x^-y truncates to 0 unless x is 1 or -1
+    if(negative != nullptr) {
+        llvm::Value *unit_base = llvm_builder->CreateICmpULE(llvm_builder->CreateAdd(x, one), llvm::ConstantInt::get(int_type, 2));
+        llvm::Value *zeroed = llvm_builder->CreateAnd(negative, llvm_builder->CreateNot(unit_base));
+        result = llvm_builder->CreateSelect(zeroed, zero, result);
+    }
+    return result;
+}
+
+llvm::CallingConv::ID get_calling_conv(int slot) {
+    SymbolTable *s = SymbolTable::getInstance();
+    if((size_t) slot < s->get_vtable_layout("Object").size()) {
+        return llvm::CallingConv::C;
+    }
+    return llvm::CallingConv::Fast;
+}
+
+void instrument_site(int site, TypeRef receiver, llvm::Value *vtable) {
+    SymbolTable *s = SymbolTable::getInstance();
+    llvm::Type *counter_type = llvm::IntegerType::getInt64Ty(* llvm_context);
+    llvm::Type *raw_type = llvm::PointerType::get(llvm::IntegerType::getInt8Ty(* llvm_context), 0);
+
+    // The clazzes a receiver can have, Object's instances being counted apart
+    std::vector<TypeRef> candidates;
+    for(auto &clazz : s->get_defined_clazzes()) {
+        TypeRef type = clazz->get_type_ref();
+        if(type == receiver || s->is_parent_of_child(receiver, type)) {
+            candidates.push_back(type);
+        }
+    }
+
+    auto counters_type = llvm::ArrayType::get(counter_type, candidates.size() + 1);
+    auto counters = new llvm::GlobalVariable(* llvm_module, counters_type, false, llvm::GlobalValue::PrivateLinkage, 
+        llvm::ConstantAggregateZero::get(counters_type), "profile");
+
+    // Select the counter of the clazz owning the vtable
+    llvm::Value *raw_vtable = llvm_builder->CreatePointerCast(vtable, raw_type);
+    llvm::Value *index = llvm::ConstantInt::get(counter_type, candidates.size());
+    for(size_t i = 0; i < candidates.size(); ++i) {
+        llvm::Value *hit = llvm_builder->CreateICmpEQ(raw_vtable, 
+            llvm::ConstantExpr::getPointerCast(llvm_vtables[candidates[i].get_clazz()], raw_type));
+        index = llvm_builder->CreateSelect(hit, llvm::ConstantInt::get(counter_type, i), index);
+    }
+
+    llvm::Value *counter = llvm_builder->CreateInBoundsGEP(counters_type, counters, {llvm::ConstantInt::get(counter_type, 0), index});
+    llvm::Value *count = llvm_builder->CreateLoad(counter);
+    llvm_builder->CreateStore(llvm_builder->CreateAdd(count, llvm::ConstantInt::get(counter_type, 1)), counter);
+
+    // Keep the counters at the number of the site, which the profile is written with
+    if(profile_counters.size() <= (size_t) site) {
+        profile_counters.resize(site + 1);
+    }
+    profile_counters[site] = {counters, candidates};
+}
+
+void write_profile() {
+    SymbolTable *s = SymbolTable::getInstance();
+    llvm::Type *counter_type = llvm::IntegerType::getInt64Ty(* llvm_context);
+    llvm::Type *site_type = llvm::IntegerType::getInt32Ty(* llvm_context);
+    llvm::Type *raw_type = llvm::PointerType::get(llvm::IntegerType::getInt8Ty(* llvm_context), 0);
+    llvm::Type *void_type = llvm::Type::getVoidTy(* llvm_context);
+
+    auto begin_f = llvm_module->getOrInsertFunction(_PROFILE_BEGIN, llvm::FunctionType::get(void_type, {raw_type}, false));
+    auto count_f = llvm_module->getOrInsertFunction(_PROFILE_COUNT, 
+        llvm::FunctionType::get(void_type, {site_type, raw_type, counter_type}, false));
+    auto end_f = llvm_module->getOrInsertFunction(_PROFILE_END, llvm::FunctionType::get(void_type, false));
+
+    // Write the counters right before 'main' returns
+    llvm::Function *main = llvm_module->getFunction("main");
+    llvm_builder->SetInsertPoint(main->getEntryBlock().getTerminator());
+
+    llvm_builder->CreateCall(begin_f, {get_string(profile_output)});
+    for(size_t site = 0; site < profile_counters.size(); ++site) {
+        auto counters = profile_counters[site].first;
+        auto &candidates = profile_counters[site].second;
+        if(counters == nullptr) {
+            continue; // Site not instrumented
+        }
+
+        for(size_t i = 0; i < candidates.size(); ++i) {
+            llvm::Value *counter = llvm_builder->CreateInBoundsGEP(counters->getValueType(), counters, 
+                {llvm::ConstantInt::get(counter_type, 0), llvm::ConstantInt::get(counter_type, i)});
+            llvm::Value *count = llvm_builder->CreateLoad(counter);
+            llvm_builder->CreateCall(count_f, {llvm::ConstantInt::get(site_type, site), 
+                get_string(s->get_type_name(candidates[i])), count});
+        }
+    }
+    llvm_builder->CreateCall(end_f);
+}
+
+TypeRef get_hot_clazz(int site, TypeRef receiver) {
+    SymbolTable *s = SymbolTable::getInstance();
+    auto counts = profile.find(site);
+    if(counts == profile.end()) {
+        return TypeRef();
+    }
+
+    std::string hot;
+    long long hot_count = 0;
+    long long total = 0;
+    for(auto &count : counts->second) {
+        total += count.second;
+        if(count.second > hot_count) {
+            hot = count.first;
+            hot_count = count.second;
+        }
+    }
+
+    // Only speculate on a majority, and on a clazz the receiver can still have
+    TypeRef type = s->get_type_ref(hot);
+    if(2 * hot_count <= total || !type.is_clazz() || llvm_vtables[type.get_clazz()] == nullptr 
+        || !(type == receiver || s->is_parent_of_child(receiver, type))) {
+        return TypeRef();
+    }
+    return type;
+}
+
+llvm::Type *get_llvm_type(TypeRef type) {
     llvm::Type *t;
-    if(type == "int32") {
+    if(type == TypeRef::int32) {
         t = llvm::IntegerType::getInt32Ty(* llvm_context);
-    } else if (type == "bool") {
+    } else if (type == TypeRef::boolean) {
         t = llvm::IntegerType::getInt1Ty(* llvm_context);
-    } else if (type == "unit") {
+    } else if (type == TypeRef::unit) {
         t = llvm::PointerType::get(llvm::PointerType::getInt8Ty(* llvm_context), 0); // Explained in doc
-    } else if (type == "string") {
+    } else if (type == TypeRef::string) {
         t = llvm::PointerType::get(llvm::PointerType::getInt8Ty(* llvm_context), 0);
     } else { // Class ref
-        t = llvm::PointerType::get(llvm_module->getTypeByName(type), 0);
+        t = llvm::PointerType::get(llvm_clazz_types[type.get_clazz()], 0);
     }
     return t;
 }
@@ -15,14 +15,15 @@
 
 class Generator {
     private:
-        Node ast; // An abstract tree
+        const Node *ast; // The checked abstract syntax tree
+        std::string module_name; // The name of the module
 
     public:
         /*
          * Generator
          *
          * input:
-         *      ast - a reference to an abstract syntax tree (Node).        
+         *      ast - a reference to the checked abstract syntax tree (Node), which must outlive the Generator.
          *      filename - a reference to the filename to write to.
          * 
          * return:
@@ -30,6 +31,13 @@ class Generator {
          */
         Generator(Node &ast, std::string &filename);
 
+        /*
+         * ~Generator
+         *
+         * Release the module of the calling thread.
+         */
+        ~Generator();
+
         /*
          * generate
          *
@@ -37,6 +45,112 @@ class Generator {
          */
         void generate();
 
+        /*
+         * compile_partitions
+         *
+         * input:
+         *      jobs - the number of partitions, each compiled on its own thread in its own context.
+         *      level - the optimization level, as for optimize.
+         *      passes - a pass pipeline overriding level if not empty, as for optimize.
+         *      time_passes - true to display the time spent in each pass of each partition, as for optimize.
+         *      runtime - the runtime linked in each partition before optimization, none if empty.
+         *      prefix - the object of the partition k is written in 'prefix.k.o'.
+         *      objects - filled with the object files to link together.
+         *
+         * Generate, optimize and emit the clazzes in jobs partitions concurrently, the clazz number c being
+         * in partition c % jobs. Each partition declares the structures of the whole program, and 'main' is in the first one.
+         * Once generated, the partitions only keep external what the other ones use.
+         * Replaces generate, optimize and emit.
+         * 
+         * return:
+         *      0 - all the objects have been written;
+         *     -1 - otherwise.
+         */
+        int compile_partitions(int jobs, int level, const std::string &passes, bool time_passes, const std::string &runtime, 
+            const std::string &prefix, std::vector<std::string> &objects);
+
+        /*
+         * instrument
+         *
+         * input:
+         *      filename - the file the generated program writes its profile to.
+         *
+         * Count the receiver clazzes of each virtual call site when the generated program runs,
+         * the counts being written in filename when 'main' returns. Must be called before generate.
+         */
+        void instrument(const std::string &filename);
+
+        /*
+         * use_profile
+         *
+         * input:
+         *      filename - a profile written by an instrumented program of the same source.
+         *
+         * Speculate on the hottest receiver clazz of each virtual call site, with a guarded direct call. 
+         * Must be called before generate.
+         * 
+         * return:
+         *      0 - the profile has been read;
+         *     -1 - the profile could not be opened.
+         */
+        int use_profile(const std::string &filename);
+
+        /*
+         * link_runtime
+         *
+         * input:
+         *      filename - the runtime, as LLVM bitcode or IR.
+         *
+         * Link the runtime definitions used by the module into it, then internalize everything but 'main',
+         * so that the optimizer can inline the runtime into the program and remove the dead code.
+         * A partition is internalized by compile_partitions instead.
+         * 
+         * return:
+         *      0 - the runtime has been linked;
+         *     -1 - the runtime could not be read or linked.
+         */
+        int link_runtime(const std::string &filename);
+
+        /*
+         * optimize
+         *
+         * input:
+         *      level - the optimization level, from 0 (only promoting the local variables to registers) to 3.
+         *      passes - a pass pipeline in the textual format of opt, which overrides level if not empty.
+         *      time_passes - true to display the time spent in each pass on the standard error stream.
+         *
+         * Run the pipeline of LLVM's new pass manager on the generated module. From -O1, the objects that do not
+         * escape their function are moved to the stack (the 'stack-alloc' function pass in a custom pipeline).
+         *
+         * return:
+         *      0 - the pipeline has run;
+         *     -1 - the pipeline could not be parsed.
+         */
+        int optimize(int level, const std::string &passes, bool time_passes);
+
+        /*
+         * print_stats
+         *
+         * Display the number of call sites, and how many of them have been devirtualized or speculated,
+         * the number of objects moved to the stack, then the number of tail calls of each kind, on the standard error stream.
+         */
+        void print_stats();
+
+        /*
+         * report_tail_calls
+         *
+         * Record the outcome of each call in tail position of a method, for print_tail_calls.
+         * Must be called before generate.
+         */
+        void report_tail_calls();
+
+        /*
+         * print_tail_calls
+         *
+         * Display each call in tail position, as 'file:line:column: outcome', on the standard error stream.
+         */
+        void print_tail_calls();
+
         /*
          * print
          *
@@ -45,16 +159,29 @@ class Generator {
         void print();
 
         /*
-         * save
+         * emit
          *
          * input:
          *      filename - a reference to the filename to write to.
+         *      assembly - true to write host assembly, false to write a host object file.
          * 
          * return:
-         *      0 - the the LLVM representation has been written in filename successfully;
+         *      0 - the module has been compiled in filename successfully;
          *     -1 - otherwise.
          */
-        int save(std::string &filename);
+        int emit(std::string &filename, bool assembly);
+
+        /*
+         * run
+         *
+         * Compile the module in memory with the ORC JIT, resolve the runtime within vsopc and call main.
+         * The module is handed over to the JIT, so the Generator cannot be used afterwards.
+         * 
+         * return:
+         *      the value returned by main;
+         *     -1 - if the module could not be compiled.
+         */
+        int run();
 };
 
 #endif//VSOPCOMPILER_GENERATOR_H
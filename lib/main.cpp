@@ -15,18 +15,21 @@
 #include "node.hpp"
 #include "generator.hpp"
 
+#include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <utility>
 #include <vector>
 
 #define COMPILER "clang"
-#define OPTIONS "-Wno-override-module -o"
+#define OPTIONS "-o"
 #define OBJECT_PATH "/tmp/vsopc/object.o /tmp/vsopc/external.o"
+#define RUNTIME_BITCODE "/tmp/vsopc/object.bc"
 #define MINIMUM_REQUIRED_ARG 1
 #define EXT_LEN 5
 #define EXT ".vsop"
 
-enum class Run {none, scanner, parser, checker, executable, generator};
+enum class Run {none, scanner, parser, checker, executable, generator, assembly, object, jit, recheck};
 
 /*
  * display_help
@@ -35,6 +38,39 @@ enum class Run {none, scanner, parser, checker, executable, generator};
  */
 static void display_help();
 
+/*
+ * read_ast
+ *
+ * input:
+ *      filename - the file to scan and parse.
+ *      ast - the AST read.
+ *
+ * The lexical and syntax errors are displayed.
+ *
+ * return:
+ *      0 - the file has been parsed;
+ *     -1 - lexical or syntax errors found;
+ *     -2 - the file could not be read.
+ */
+static int read_ast(const std::string &filename, Node &ast);
+
+/*
+ * recheck
+ *
+ * input:
+ *      filename - the original file.
+ *      edited - the edited file.
+ *      jobs - the number of threads checking the method bodies.
+ *
+ * Check filename, then edited reusing the first check, and compare the result with a
+ * fresh check of edited. The number of reused methods and the errors are displayed.
+ *
+ * return:
+ *      0 - the incremental check found the same errors as the fresh one;
+ *     -1 - they differ, or a file could not be parsed.
+ */
+static int recheck(const std::string &filename, const std::string &edited, int jobs);
+
 int main(int argc, char **argv) {
 
     // Check the number of arguments
@@ -44,7 +80,17 @@ int main(int argc, char **argv) {
     }
 
     std::string filename;
+    std::string edited;
     Run mode = Run::none; 
+    int jobs = 1;
+    int codegen_jobs = 1;
+    int opt_level = 0;
+    std::string passes;
+    bool time_passes = false;
+    bool stats = false;
+    bool report_tail_calls = false;
+    std::string profile_generate;
+    std::string profile_use;
 
     // check the quality of the arguments
     for(int i = 1; i < argc; ++i) {
@@ -79,6 +125,17 @@ int main(int argc, char **argv) {
                 std::cerr << "-c -sem option requires one argument." << std::endl;
                 return -1;
             }
+        } else if (std::string(argv[i]) == "--recheck") {
+
+            // Make sure two files in input
+            if (i + 2 < argc) {
+                filename = argv[++i];
+                edited = argv[++i];
+                mode = Run::recheck;
+            } else {
+                std::cerr << "--recheck option requires two arguments." << std::endl;
+                return -1;
+            }
         } else if (std::string(argv[i]) == "-llvm" or std::string(argv[i]) == "-i") {
 
             // Make sure a file in input
@@ -89,12 +146,103 @@ int main(int argc, char **argv) {
                 std::cerr << "-i -llvm option requires one argument." << std::endl;
                 return -1;
             }
+        } else if (std::string(argv[i]) == "-S") {
+
+            // Make sure a file in input
+            if (i + 1 < argc) {
+                filename = argv[++i];
+                mode = Run::assembly;
+            } else {
+                std::cerr << "-S option requires one argument." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]) == "-emit-obj") {
+
+            // Make sure a file in input
+            if (i + 1 < argc) {
+                filename = argv[++i];
+                mode = Run::object;
+            } else {
+                std::cerr << "-emit-obj option requires one argument." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]) == "--run") {
+
+            // Make sure a file in input, the remaining arguments are left to the program
+            if (i + 1 < argc) {
+                filename = argv[++i];
+                mode = Run::jit;
+                break;
+            } else {
+                std::cerr << "--run option requires one argument." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]) == "--jobs" or std::string(argv[i]) == "-j") {
+
+            // Make sure a number of jobs in input
+            if (i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+                jobs = std::atoi(argv[++i]);
+            } else {
+                std::cerr << "-j --jobs option requires a positive number." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]) == "--codegen-jobs") {
+
+            // Make sure a number of partitions in input
+            if (i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+                codegen_jobs = std::atoi(argv[++i]);
+            } else {
+                std::cerr << "--codegen-jobs option requires a positive number." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]).size() == 3 && std::string(argv[i]).compare(0, 2, "-O") == 0) {
+
+            // Make sure a level between 0 and 3
+            if (argv[i][2] >= '0' && argv[i][2] <= '3') {
+                opt_level = argv[i][2] - '0';
+            } else {
+                std::cerr << "-O option requires a level between 0 and 3." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]).compare(0, 9, "--passes=") == 0) {
+
+            // Make sure a pipeline in input
+            passes = std::string(argv[i]).substr(9);
+            if (passes.empty()) {
+                std::cerr << "--passes= option requires a pass pipeline." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]).compare(0, 19, "--profile-generate=") == 0) {
+
+            // Make sure a profile file in input
+            profile_generate = std::string(argv[i]).substr(19);
+            if (profile_generate.empty()) {
+                std::cerr << "--profile-generate= option requires a file." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]).compare(0, 14, "--profile-use=") == 0) {
+
+            // Make sure a profile file in input
+            profile_use = std::string(argv[i]).substr(14);
+            if (profile_use.empty()) {
+                std::cerr << "--profile-use= option requires a file." << std::endl;
+                return -1;
+            }
+        } else if (std::string(argv[i]) == "--time-passes") {
+            time_passes = true;
+
+        } else if (std::string(argv[i]) == "--stats") {
+            stats = true;
+
+        } else if (std::string(argv[i]) == "--report-tail-calls") {
+            report_tail_calls = true;
+
         } else if (std::string(argv[i]) == "-h" || std::string(argv[i]) == "--help") {
             display_help();
             return 0;
 
         } else {
-            filename = argv[1];
+            filename = argv[i];
             mode = Run::executable;
         }
     }
@@ -105,6 +253,20 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    // The partitions are linked in an executable only, and the profile numbers the call sites of a single module
+    if(codegen_jobs > 1 && (mode != Run::executable || !profile_generate.empty() || !profile_use.empty())) {
+        std::cerr << "--codegen-jobs option only applies to an executable, without a profile." << std::endl;
+        return -1;
+    }
+
+    if(mode == Run::recheck) {
+        if(edited.size() < EXT_LEN || edited.substr(edited.size() - EXT_LEN).compare(EXT) != 0) {
+            std::cerr << "Input file must be of '.vsop' extension." << std::endl;
+            return -1;
+        }
+        return recheck(filename, edited, jobs);
+    }
+
     std::vector<Token> token_vector;
     std::vector<Error> error_vector;
 
@@ -167,10 +329,10 @@ int main(int argc, char **argv) {
     }
 
     // Create a checker that will create the extanded tree
-    Checker checker(ast);
+    Checker checker(std::move(ast), jobs);
     checker.check();
 
-    Node expanded = checker.get_expanded_AST();
+    Node &expanded = checker.get_expanded_AST();
     error_vector = checker.get_errors();
 
     // Display the expanded tree if parser mode
@@ -192,31 +354,157 @@ int main(int argc, char **argv) {
 
     // LLVM code generation
     Generator llvm_generator(expanded, filename);
+    if(!profile_generate.empty()) {
+        llvm_generator.instrument(profile_generate);
+    }
+    if(report_tail_calls) {
+        llvm_generator.report_tail_calls();
+    }
+    if(!profile_use.empty() && llvm_generator.use_profile(profile_use) != 0) {
+        std::cerr << "Error while reading " + profile_use << std::endl;
+        return -1;
+    }
+
+    std::string exec = filename.substr(0, filename.length() - EXT_LEN);
+    bool optimizing = opt_level > 0 || !passes.empty();
+
+    // Compile the executable in partitions concurrently
+    if(codegen_jobs > 1) {
+        std::vector<std::string> objects;
+        if(llvm_generator.compile_partitions(codegen_jobs, opt_level, passes, time_passes, optimizing ? RUNTIME_BITCODE : "", exec, objects) != 0) {
+            std::cerr << "Error while writing the objects of " + exec << std::endl;
+            return -1;
+        }
+        if(stats) {
+            llvm_generator.print_stats();
+        }
+        if(report_tail_calls) {
+            llvm_generator.print_tail_calls();
+        }
+
+        // Link the partitions in 'filename'
+        std::string command = std::string(COMPILER) + " " + OPTIONS + " " + exec + " " + OBJECT_PATH;
+        for(auto &object : objects) {
+            command += " " + object;
+        }
+        std::system(command.c_str());
+
+        for(auto &object : objects) {
+            std::remove(object.c_str());
+        }
+        return 0;
+    }
+
     llvm_generator.generate();
+    if(report_tail_calls) {
+        llvm_generator.print_tail_calls();
+    }
+
+    // Link the runtime in the module to optimize them together
+    if(optimizing && llvm_generator.link_runtime(RUNTIME_BITCODE) != 0) {
+        std::cerr << "Error while linking " RUNTIME_BITCODE << std::endl;
+        return -1;
+    }
+
+    // LLVM optimization
+    if(llvm_generator.optimize(opt_level, passes, time_passes) != 0) {
+        return -1;
+    }
+    if(stats) {
+        llvm_generator.print_stats();
+    }
 
     if(mode == Run::generator) {
         // Print on std output stream
         llvm_generator.print();
         return 0;
     } 
-    
-    // Save LLVM IR in 'filename.ll'
-    std::string exec = filename.substr(0, filename.length() - EXT_LEN);
-    std::string ll_f = std::string(exec).append(".ll");
 
-    int ret = llvm_generator.save(ll_f);
-    if(ret != 0) {
-        std::cerr << "Error while writing in " + ll_f << std::endl;
+    if(mode == Run::jit) {
+        // Compile in memory and run main
+        return llvm_generator.run();
+    }
+
+    // Write the host assembly in 'filename.s'
+    if(mode == Run::assembly) {
+        std::string s_f = std::string(exec).append(".s");
+        if(llvm_generator.emit(s_f, true) != 0) {
+            std::cerr << "Error while writing in " + s_f << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    // Write the host object in 'filename.o'
+    std::string o_f = std::string(exec).append(".o");
+    if(llvm_generator.emit(o_f, false) != 0) {
+        std::cerr << "Error while writing in " + o_f << std::endl;
         return -1;
     }
 
-    // Build the executable in 'filename'
-    const std::string command = std::string(COMPILER) + " " + OPTIONS + " " + exec + " " + OBJECT_PATH + " " + ll_f;
+    if(mode == Run::object) {
+        return 0;
+    }
+
+    // Link the executable in 'filename'
+    const std::string command = std::string(COMPILER) + " " + OPTIONS + " " + exec + " " + OBJECT_PATH + " " + o_f;
     std::system(command.c_str());
 
     return 0;
 }
 
+int read_ast(const std::string &filename, Node &ast) {
+    Error::set_filename(filename);
+
+    Scanner scanner(filename);
+    if(scanner.scan() == -2) { // File error
+        return -2;
+    }
+
+    std::vector<Error> error_vector = scanner.get_errors();
+    if(error_vector.empty()) {
+        yy::Parser Parser(scanner);
+        Parser.parse();
+
+        ast = Parser.get_ast();
+        error_vector = Parser.get_errors();
+    }
+
+    for(auto &i : error_vector) {
+        i.print_error_msg();
+    }
+    return error_vector.empty() ? 0 : -1;
+}
+
+int recheck(const std::string &filename, const std::string &edited, int jobs) {
+    Node ast, edited_ast;
+    if(read_ast(filename, ast) != 0 || read_ast(edited, edited_ast) != 0) {
+        return -1;
+    }
+    Node fresh_ast = edited_ast;
+
+    // The first check records what the second one may reuse
+    Checker checker(std::move(ast), jobs, true);
+    checker.check();
+
+    Checker incremental(std::move(edited_ast), jobs, true, &checker);
+    incremental.check();
+    std::vector<Error> error_vector = incremental.get_errors();
+    std::cout << incremental.get_reused_count() << "/" << incremental.get_method_count() << " methods reused" << std::endl;
+
+    Checker fresh(std::move(fresh_ast), jobs);
+    fresh.check();
+
+    for(auto &i : error_vector) {
+        i.print_error_msg();
+    }
+    if(!(error_vector == fresh.get_errors())) {
+        std::cerr << "The errors differ from a fresh check of " + edited << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
 void display_help() {
     std::cout << "This program is the beginning of a long road to build a compiler..." << std::endl;
     std::cout << "Here are the option:" << std::endl;
@@ -224,7 +512,20 @@ void display_help() {
     std::cout << "\t-par | -p <path-to-file>\n\t\tParse the file and display an AST." << std::endl;
     std::cout << "\t-sem | -c <path-to-file>\n\t\tParse the parsing AST and display an expanded AST." << std::endl;
     std::cout << "\t-llvm| -i <path-to-file>\n\t\tGenerate LLVM IR code and display." << std::endl;
+    std::cout << "\t-S <path-to-file>       \n\t\tGenerate host assembly code in a '.s' file." << std::endl;
+    std::cout << "\t-emit-obj <path-to-file>\n\t\tGenerate a host object in a '.o' file." << std::endl;
+    std::cout << "\t--run <path-to-file> [args]\n\t\tCompile the file in memory and run it; the arguments are not parsed." << std::endl;
+    std::cout << "\t--recheck <path-to-file> <path-to-edited-file>\n\t\tCheck the file, then the edited one reusing the unchanged methods, and compare with a fresh check." << std::endl;
     std::cout << "\t<path-to-file>          \n\t\tGenerate an executable." << std::endl;
+    std::cout << "\t-j | --jobs <n>         \n\t\tCheck the method bodies on n threads." << std::endl;
+    std::cout << "\t--codegen-jobs <n>      \n\t\tGenerate and optimize the executable in n partitions concurrently." << std::endl;
+    std::cout << "\t-O0 | -O1 | -O2 | -O3   \n\t\tOptimize the LLVM IR code at the given level (default -O0)." << std::endl;
+    std::cout << "\t--passes=<pipeline>     \n\t\tRun the given LLVM pass pipeline instead of the -O level." << std::endl;
+    std::cout << "\t--time-passes           \n\t\tDisplay the time spent in each LLVM pass." << std::endl;
+    std::cout << "\t--profile-generate=<file>\n\t\tCount the receiver classes of virtual calls at run time, in file." << std::endl;
+    std::cout << "\t--profile-use=<file>    \n\t\tSpeculate on the hottest receiver class of each virtual call of the profile." << std::endl;
+    std::cout << "\t--stats                 \n\t\tDisplay the number of devirtualized call sites, stack allocated objects and tail calls." << std::endl;
+    std::cout << "\t--report-tail-calls     \n\t\tDisplay each call in tail position, and whether it became a loop or a tail call." << std::endl;
     std::cout << "\tErrors are displayed onto the standard error stream." << std::endl;
     std::cout << "\n\t-h --help          \tRecursion." << std::endl;
 }
@@ -10,24 +10,67 @@
  */
 #include "node.hpp"
 #include "symbol_table.hpp"
+#include "stack_segment.hpp"
 
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+
+static std::unordered_map<std::string, int> symbols; // A < identifier - symbol > mapping, filled as nodes are created
+static std::mutex symbols_mutex; // Guards symbols
 
 Node::Node() {
 	type = NodeType::none;
+	line = 0;
+	column = 0;
+	decl = nullptr;
+	slot = -1;
+	symbol = -1;
 }
 
 Node::Node(NodeType t, int l, int c) {
 	type = t;
 	line = l;
 	column = c;
+	decl = nullptr;
+	slot = -1;
+	symbol = -1;
+}
+
+Node::Node(const Node &n) : type(n.type), line(n.line), column(n.column), data(n.data), decl(n.decl), type_ref(n.type_ref), slot(n.slot), 
+	symbol(n.symbol) {
+	// Copy the children on a new stack segment if this one is too deep for their copy
+	if(StackSegment::is_exhausted()) {
+		StackSegment::grow([this, &n]() {
+			children = n.children;
+		});
+	} else {
+		children = n.children;
+	}
+}
+
+Node &Node::operator=(const Node &n) {
+	Node copy(n);
+	*this = std::move(copy);
+	return *this;
+}
+
+Node::~Node() {
+	// Destroy the children on a new stack segment if this one is too deep for their destructors
+	if(StackSegment::is_exhausted()) {
+		StackSegment::grow([this]() {
+			children.clear();
+		});
+	}
 }
 
 Node Node::create_program(int line, int column, std::vector<Node> clazzes) {
 	Node n = Node(NodeType::program, line, column);
 
-	n.children[NodeType::clazz] = clazzes;
+	n.children[NodeType::clazz] = std::move(clazzes);
 
 	return n;
 }
@@ -38,8 +81,8 @@ Node Node::create_clazz(int line, int column, std::string id, std::string parent
 	n.data[DataType::id] = id;
 	n.data[DataType::parent_id] = parent;
 
-	n.children[NodeType::field] = fields;
-	n.children[NodeType::method] = methods;
+	n.children[NodeType::field] = std::move(fields);
+	n.children[NodeType::method] = std::move(methods);
 
 	return n;
 }
@@ -51,7 +94,7 @@ Node Node::create_field(int line, int column, std::string id, std::string type,
 	n.data[DataType::type] = type;
 
 	if(!expr.is_empty()) {
-		n.children[NodeType::any_expr] = {expr};
+		n.children[NodeType::any_expr].push_back(std::move(expr));
 	} 
 	return n;
 }
@@ -62,8 +105,8 @@ Node Node::create_method(int line, int column, std::string id, std::vector<Node>
 	n.data[DataType::id] = id;
 	n.data[DataType::type] = type;
 
-	n.children[NodeType::formal] = formals;
-	n.children[NodeType::block] = {block};
+	n.children[NodeType::formal] = std::move(formals);
+	n.children[NodeType::block].push_back(std::move(block));
 
 	return n;
 }
@@ -73,6 +116,7 @@ Node Node::create_formal(int line, int column, std::string id, std::string type)
 
 	n.data[DataType::id] = id;
 	n.data[DataType::type] = type;
+	n.symbol = intern(id);
 
 	return n;
 }
@@ -80,7 +124,7 @@ Node Node::create_formal(int line, int column, std::string id, std::string type)
 Node Node::create_block(int line, int column, std::vector<Node> exprs) {
 	Node n = Node(NodeType::block, line, column);
 
-	n.children[NodeType::any_expr] = exprs;
+	n.children[NodeType::any_expr] = std::move(exprs);
 
 	return n;
 }
@@ -88,10 +132,10 @@ Node Node::create_block(int line, int column, std::vector<Node> exprs) {
 Node Node::create_if_expr(int line, int column, Node if_expr, Node then_expr, Node else_expr) {
 	Node n = Node(NodeType::if_expr, line, column);
 
-	n.children[NodeType::if_statement] = {if_expr};
-	n.children[NodeType::then_statement] = {then_expr};
+	n.children[NodeType::if_statement].push_back(std::move(if_expr));
+	n.children[NodeType::then_statement].push_back(std::move(then_expr));
 	if(!else_expr.is_empty()) {
-		n.children[NodeType::else_statement] = {else_expr};
+		n.children[NodeType::else_statement].push_back(std::move(else_expr));
 	} 
 	return n;
 }
@@ -99,8 +143,8 @@ Node Node::create_if_expr(int line, int column, Node if_expr, Node then_expr, No
 Node Node::create_while_expr(int line, int column, Node while_expr, Node do_expr) {
 	Node n = Node(NodeType::while_expr, line, column);
 
-	n.children[NodeType::while_statement] = {while_expr};
-	n.children[NodeType::do_statement] = {do_expr};
+	n.children[NodeType::while_statement].push_back(std::move(while_expr));
+	n.children[NodeType::do_statement].push_back(std::move(do_expr));
 
 	return n;
 }
@@ -109,9 +153,9 @@ Node Node::create_let_expr(int line, int column, std::string id, std::string typ
 	Node n = Node(NodeType::let_expr, line, column);
 
 	n.children[NodeType::object_identifier] = {Node::create_object_identifier(line, column, id, type)};
-	n.children[NodeType::scope_statement] = {scope_expr};
+	n.children[NodeType::scope_statement].push_back(std::move(scope_expr));
 	if(!init_expr.is_empty()) {
-		n.children[NodeType::init_statement] = {init_expr};
+		n.children[NodeType::init_statement].push_back(std::move(init_expr));
 	}
 	return n;
 }
@@ -120,7 +164,8 @@ Node Node::create_assign_expr(int line, int column, std::string id, Node expr) {
 	Node n = Node(NodeType::assign_expr, line, column);
 
 	n.data[DataType::id] = id;
-	n.children[NodeType::any_expr] = {expr};
+	n.symbol = intern(id);
+	n.children[NodeType::any_expr].push_back(std::move(expr));
 
 	return n;
 }
@@ -129,7 +174,7 @@ Node Node::create_unop_expr(int line, int column, std::string op, Node expr) {
 	Node n = Node(NodeType::unop_expr, line, column);
 
 	n.data[DataType::op] = op;
-	n.children[NodeType::any_expr] = {expr};
+	n.children[NodeType::any_expr].push_back(std::move(expr));
 
 	return n;
 }
@@ -138,8 +183,8 @@ Node Node::create_binop_expr(int line, int column, std::string op, Node left_exp
 	Node n = Node(NodeType::binop_expr, line, column);
 
 	n.data[DataType::op] = op;
-	n.children[NodeType::left_statement] = {left_expr};
-	n.children[NodeType::right_statement] = {right_expr};
+	n.children[NodeType::left_statement].push_back(std::move(left_expr));
+	n.children[NodeType::right_statement].push_back(std::move(right_expr));
 
 	return n;
 }
@@ -148,8 +193,8 @@ Node Node::create_call_expr(int line, int column, Node parent_expr, std::string
 	Node n = Node(NodeType::call_expr, line, column);
 
 	n.data[DataType::id] = id;
-	n.children[NodeType::parent_statement] = {parent_expr};
-	n.children[NodeType::args] = args;
+	n.children[NodeType::parent_statement].push_back(std::move(parent_expr));
+	n.children[NodeType::args] = std::move(args);
 
 	return n;
 }
@@ -198,6 +243,7 @@ Node Node::create_object_identifier(int line, int column, std::string value, std
 
 	n.data[DataType::literal_value] = value;
 	n.data[DataType::type] = type;
+	n.symbol = intern(value);
 	return n;
 }
 
@@ -205,42 +251,155 @@ void Node::add_clazz(Node &c) {
 	if(c.type != NodeType::clazz) {
 		return;
 	}
-	children[NodeType::clazz].push_back(c);
+	children[NodeType::clazz].push_back(std::move(c));
+}
+
+const std::vector<Node> &Node::get_children(NodeType t) const {
+	static const std::vector<Node> none;
+
+	auto it = children.find(t);
+	if(it == children.end()) {
+		return none;
+	}
+	return it->second;
 }
 
-std::vector<Node> Node::get_children(NodeType t) {
-	return children[t];
+std::vector<Node> &Node::get_children(NodeType t) {
+	// Only insert a missing key, so that existing children can be reached while other threads read the node
+	auto it = children.find(t);
+	if(it == children.end()) {
+		it = children.emplace(t, std::vector<Node>()).first;
+	}
+	return it->second;
 }
 
-std::string Node::get_data(DataType t) {
-	return data[t];
+std::vector<NodeType> Node::get_children_types() const {
+	std::vector<NodeType> types;
+	for(auto &child : children) {
+		types.push_back(child.first);
+	}
+	return types;
 }
 
-int Node::get_line() {
+std::string Node::get_data(DataType t) const {
+	auto it = data.find(t);
+	if(it == data.end()) {
+		return std::string();
+	}
+	return it->second;
+}
+
+int Node::get_line() const {
 	return line;
 }
 
-int Node::get_column() {
+int Node::get_column() const {
 	return column;
 }
 
-NodeType Node::get_type() {
+NodeType Node::get_type() const {
 	return type;
 }
 
+const Node *Node::get_decl() const {
+	return decl;
+}
+
+void Node::set_decl(const Node *d) {
+	decl = d;
+}
+
+int Node::get_slot() const {
+	return slot;
+}
+
+void Node::set_slot(int i) {
+	slot = i;
+}
+
+int Node::get_symbol() const {
+	return symbol;
+}
+
+int Node::intern(const std::string &name) {
+	std::lock_guard<std::mutex> lock(symbols_mutex);
+	return symbols.emplace(name, (int) symbols.size()).first->second;
+}
+
 void Node::set_children(NodeType t, std::vector<Node> v) {
-	children[t] = v;
+	children[t] = std::move(v);
 }
 
 void Node::set_return_type(std::string &t) {
 	data[DataType::type] = t;
 }
 
-bool Node::is_empty() {
+TypeRef Node::get_type_ref() const {
+	return type_ref;
+}
+
+void Node::set_type_ref(TypeRef t) {
+	type_ref = t;
+}
+
+size_t Node::hash(int base_line) const {
+	size_t h = std::hash<int>()((int) type);
+
+	if(StackSegment::is_exhausted()) {
+		StackSegment::grow([this, &h, base_line]() {
+			h = hash(base_line);
+		});
+		return h;
+	}
+
+	auto combine = [&h](size_t v) {
+		h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+	};
+
+	combine(std::hash<int>()(line - base_line));
+	combine(std::hash<int>()(column));
+	for(auto &d : data) {
+		combine(std::hash<int>()((int) d.first));
+		combine(std::hash<std::string>()(d.second));
+	}
+	for(auto &child : children) {
+		combine(std::hash<int>()((int) child.first));
+		combine(child.second.size());
+		for(auto &c : child.second) {
+			combine(c.hash(base_line));
+		}
+	}
+	return h;
+}
+
+void Node::shift_lines(int delta) {
+	if(StackSegment::is_exhausted()) {
+		StackSegment::grow([this, delta]() {
+			shift_lines(delta);
+		});
+		return;
+	}
+
+	line += delta;
+	for(auto &child : children) {
+		for(auto &c : child.second) {
+			c.shift_lines(delta);
+		}
+	}
+}
+
+bool Node::is_empty() const {
 	return (type == NodeType::none);
 }
 
 void Node::print(bool expanded) {
+	if(StackSegment::is_exhausted()) {
+		StackSegment::grow([this, expanded]() {
+			print(expanded);
+		});
+		return;
+	}
+
 	switch (type) {
 		case NodeType::program:
 			std::cout << "[";
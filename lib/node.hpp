@@ -8,6 +8,8 @@
  * Created   15/03/21
  * Modified  20/03/21
  */
+#include "type_ref.hpp"
+
 #include <iostream>
 #include <vector>
 #include <map>
@@ -35,6 +37,10 @@ class Node {
         int column; // The column index of the beginning of the node
         std::map<NodeType, std::vector<Node> > children; // A map of children node           
         std::map<DataType, std::string> data; // A map of strings used to maintain data
+        const Node *decl; // The declaration an identifier, assign or call resolves to (the parent of a clazz), if any
+        TypeRef type_ref; // The interned type set by the checker
+        int slot; // The vtable index of a call or the structure index of a field access, -1 if none
+        int symbol; // The interned name of a formal, assign or object identifier, -1 if none
         
     public:
         /*
@@ -53,6 +59,18 @@ class Node {
          */
     	Node(NodeType t, int l, int c);
 
+        /*
+         * Node copy and move constructors, assignments and destructor
+         *
+         * The children are copied and destroyed on a new stack segment when the
+         * current one is exhausted, so that a deep AST does not overflow the stack.
+         */
+        Node(const Node &n);
+        Node(Node &&n) = default;
+        Node &operator=(const Node &n);
+        Node &operator=(Node &&n) = default;
+        ~Node();
+
         /*
          * create_* constructors
          *
@@ -94,9 +112,18 @@ class Node {
          *      t - the type of the wanted children.
          *
          * return:
-         *      the vector of children of type t.
+         *      a reference to the vector of children of type t, empty if none.
          */
-        std::vector<Node> get_children(NodeType t);
+        const std::vector<Node> &get_children(NodeType t) const;
+        std::vector<Node> &get_children(NodeType t);
+
+        /*
+         * get_children_types
+         *
+         * return:
+         *      the types of children the node holds, in order.
+         */
+        std::vector<NodeType> get_children_types() const;
 
         /*
          * get_data
@@ -107,7 +134,7 @@ class Node {
          * return:
          *      the data of type t.
          */
-        std::string get_data(DataType t);
+        std::string get_data(DataType t) const;
 
         /*
          * get_line
@@ -115,7 +142,7 @@ class Node {
          * return:
          *      line - the line of the node.
          */
-        int get_line();
+        int get_line() const;
 
         /*
          * get_column
@@ -123,7 +150,7 @@ class Node {
          * return:
          *      column - the column of the node.
          */
-        int get_column();
+        int get_column() const;
 
         /*
          * get_type
@@ -131,7 +158,60 @@ class Node {
          * return:
          *      type - the type of the node.
          */
-        NodeType get_type();
+        NodeType get_type() const;
+
+        /*
+         * get_decl
+         *
+         * return:
+         *      a pointer to the declaration the node resolves to, nullptr if none.
+         */
+        const Node *get_decl() const;
+
+        /*
+         * set_decl
+         *
+         * input:
+         *      d - a pointer to the field or method declaration the node resolves to.
+         */
+        void set_decl(const Node *d);
+
+        /*
+         * get_slot
+         *
+         * return:
+         *      the vtable index of a call, or the structure index of a field access,
+         *      -1 if none.
+         */
+        int get_slot() const;
+
+        /*
+         * set_slot
+         *
+         * input:
+         *      i - the vtable or structure index resolved for the node.
+         */
+        void set_slot(int i);
+
+        /*
+         * get_symbol
+         *
+         * return:
+         *      the interned name of a formal, assign or object identifier, the same for the same name,
+         *      -1 if none.
+         */
+        int get_symbol() const;
+
+        /*
+         * intern
+         *
+         * input:
+         *      name - an identifier.
+         * 
+         * return:
+         *      the symbol of the identifier, the symbols being numbered from 0 in order of first use.
+         */
+        static int intern(const std::string &name);
 
         /*
          * set_return_type
@@ -141,6 +221,22 @@ class Node {
          */
         void set_return_type(std::string &t);
 
+        /*
+         * get_type_ref
+         *
+         * return:
+         *      the interned type of the node, none if not checked.
+         */
+        TypeRef get_type_ref() const;
+
+        /*
+         * set_type_ref
+         *
+         * input:
+         *      t - the interned type of the node.
+         */
+        void set_type_ref(TypeRef t);
+
         /*
          * set_children
          *
@@ -154,10 +250,35 @@ class Node {
          * add_clazz
          *
          * input:
-         *      c - the clazz node to add to the clazz children list.
+         *      c - the clazz node to move into the clazz children list.
          */
         void add_clazz(Node &c);
 
+        /*
+         * hash
+         *
+         * input:
+         *      base_line - the line the positions are hashed relative to.
+         *
+         * Hash the node as parsed: its type, position, data and children. The annotations
+         * set by the checker are not hashed, but the types it displays are (hash before checking).
+         * Hashed relative to its own line, a subtree moved by a few lines keeps its hash.
+         *
+         * return:
+         *      the hash of the subtree rooted at the node.
+         */
+        size_t hash(int base_line = 0) const;
+
+        /*
+         * shift_lines
+         *
+         * input:
+         *      delta - the number of lines to move by.
+         *
+         * Move the subtree rooted at the node by delta lines.
+         */
+        void shift_lines(int delta);
+
         /*
          * is_empty
          *
@@ -165,7 +286,7 @@ class Node {
          *      true - if the node is empty;
          *      false - otherwise.
          */
-        bool is_empty();
+        bool is_empty() const;
 
         /*
          * is_empty
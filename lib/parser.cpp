@@ -45,6 +45,7 @@
 #line 33 "lib/parser.yy"
  
 	#include <iostream>
+	#include <utility>
 	#include <vector>
 
 	namespace yy { 
@@ -62,7 +63,7 @@
 	std::vector<std::vector<Node>> block_vec = {std::vector<Node>()};
 	std::vector<std::vector<Node>> args_vec = {std::vector<Node>()};
 
-#line 66 "lib/parser.cpp"
+#line 67 "lib/parser.cpp"
 
 
 #ifndef YY_
@@ -154,7 +155,7 @@
 #define YYRECOVERING()  (!!yyerrstatus_)
 
 namespace yy {
-#line 158 "lib/parser.cpp"
+#line 159 "lib/parser.cpp"
 
   /// Build a parser object.
    Parser :: Parser  (Scanner &scanner_yyarg)
@@ -641,367 +642,367 @@ namespace yy {
           switch (yyn)
             {
   case 2: // program: clazz
-#line 128 "lib/parser.yy"
-                              { ast = Node::create_program(1, 1, {yystack_[0].value.as < Node > ()}); }
-#line 647 "lib/parser.cpp"
+#line 129 "lib/parser.yy"
+                              { ast = Node::create_program(1, 1, {}); ast.add_clazz(yystack_[0].value.as < Node > ()); }
+#line 648 "lib/parser.cpp"
     break;
 
   case 3: // program: program clazz
-#line 129 "lib/parser.yy"
+#line 130 "lib/parser.yy"
                                               { ast.add_clazz(yystack_[0].value.as < Node > ()); }
-#line 653 "lib/parser.cpp"
+#line 654 "lib/parser.cpp"
     break;
 
   case 4: // $@1: %empty
-#line 131 "lib/parser.yy"
+#line 132 "lib/parser.yy"
                                         { cur_clazz = yystack_[0].value.as < std::string > (); }
-#line 659 "lib/parser.cpp"
+#line 660 "lib/parser.cpp"
     break;
 
   case 5: // clazz: "class" TYPE_ID $@1 clazzbody
-#line 131 "lib/parser.yy"
-                                                                      { yylhs.value.as < Node > () = Node::create_clazz(yystack_[3].location.begin.line, yystack_[3].location.begin.column, yystack_[2].value.as < std::string > (), "Object", fields_vec[ctx], methods_vec[ctx]); fields_vec[ctx].clear(); methods_vec[ctx].clear(); }
-#line 665 "lib/parser.cpp"
+#line 132 "lib/parser.yy"
+                                                                      { yylhs.value.as < Node > () = Node::create_clazz(yystack_[3].location.begin.line, yystack_[3].location.begin.column, yystack_[2].value.as < std::string > (), "Object", std::move(fields_vec[ctx]), std::move(methods_vec[ctx])); fields_vec[ctx].clear(); methods_vec[ctx].clear(); }
+#line 666 "lib/parser.cpp"
     break;
 
   case 6: // $@2: %empty
-#line 132 "lib/parser.yy"
+#line 133 "lib/parser.yy"
                                                                   { cur_clazz = yystack_[2].value.as < std::string > (); }
-#line 671 "lib/parser.cpp"
+#line 672 "lib/parser.cpp"
     break;
 
   case 7: // clazz: "class" TYPE_ID "extends" TYPE_ID $@2 clazzbody
-#line 132 "lib/parser.yy"
-                                                                                                { yylhs.value.as < Node > () = Node::create_clazz(yystack_[5].location.begin.line, yystack_[5].location.begin.column, yystack_[4].value.as < std::string > (), yystack_[2].value.as < std::string > (), fields_vec[ctx], methods_vec[ctx]); fields_vec[ctx].clear(); methods_vec[ctx].clear(); }
-#line 677 "lib/parser.cpp"
+#line 133 "lib/parser.yy"
+                                                                                                { yylhs.value.as < Node > () = Node::create_clazz(yystack_[5].location.begin.line, yystack_[5].location.begin.column, yystack_[4].value.as < std::string > (), yystack_[2].value.as < std::string > (), std::move(fields_vec[ctx]), std::move(methods_vec[ctx])); fields_vec[ctx].clear(); methods_vec[ctx].clear(); }
+#line 678 "lib/parser.cpp"
     break;
 
   case 10: // body: body field
-#line 137 "lib/parser.yy"
-                                           { fields_vec[ctx].push_back(yystack_[0].value.as < Node > ()); }
-#line 683 "lib/parser.cpp"
+#line 138 "lib/parser.yy"
+                                           { fields_vec[ctx].push_back(std::move(yystack_[0].value.as < Node > ())); }
+#line 684 "lib/parser.cpp"
     break;
 
   case 11: // body: body method
-#line 138 "lib/parser.yy"
-                                            { methods_vec[ctx].push_back(yystack_[0].value.as < Node > ()); }
-#line 689 "lib/parser.cpp"
+#line 139 "lib/parser.yy"
+                                            { methods_vec[ctx].push_back(std::move(yystack_[0].value.as < Node > ())); }
+#line 690 "lib/parser.cpp"
     break;
 
   case 12: // field: OBJ_ID ":" type ";"
-#line 140 "lib/parser.yy"
+#line 141 "lib/parser.yy"
                                             { yylhs.value.as < Node > () = Node::create_field(yystack_[3].location.begin.line, yystack_[3].location.begin.column, yystack_[3].value.as < std::string > (), yystack_[1].value.as < std::string > ()); }
-#line 695 "lib/parser.cpp"
+#line 696 "lib/parser.cpp"
     break;
 
   case 13: // field: OBJ_ID ":" type "<-" expr ";"
-#line 141 "lib/parser.yy"
-                                                              { yylhs.value.as < Node > () = Node::create_field(yystack_[5].location.begin.line, yystack_[5].location.begin.column, yystack_[5].value.as < std::string > (), yystack_[3].value.as < std::string > (), yystack_[1].value.as < Node > ()); }
-#line 701 "lib/parser.cpp"
+#line 142 "lib/parser.yy"
+                                                              { yylhs.value.as < Node > () = Node::create_field(yystack_[5].location.begin.line, yystack_[5].location.begin.column, yystack_[5].value.as < std::string > (), yystack_[3].value.as < std::string > (), std::move(yystack_[1].value.as < Node > ())); }
+#line 702 "lib/parser.cpp"
     break;
 
   case 14: // method: OBJ_ID "(" formals ")" ":" type block
-#line 143 "lib/parser.yy"
-                                                              { yylhs.value.as < Node > () = Node::create_method(yystack_[6].location.begin.line, yystack_[6].location.begin.column, yystack_[6].value.as < std::string > (), formals_vec[ctx], yystack_[1].value.as < std::string > (), yystack_[0].value.as < Node > ()); formals_vec[ctx].clear(); }
-#line 707 "lib/parser.cpp"
+#line 144 "lib/parser.yy"
+                                                              { yylhs.value.as < Node > () = Node::create_method(yystack_[6].location.begin.line, yystack_[6].location.begin.column, yystack_[6].value.as < std::string > (), std::move(formals_vec[ctx]), yystack_[1].value.as < std::string > (), std::move(yystack_[0].value.as < Node > ())); formals_vec[ctx].clear(); }
+#line 708 "lib/parser.cpp"
     break;
 
   case 15: // type: TYPE_ID
-#line 145 "lib/parser.yy"
+#line 146 "lib/parser.yy"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
-#line 713 "lib/parser.cpp"
+#line 714 "lib/parser.cpp"
     break;
 
   case 16: // type: "int32"
-#line 146 "lib/parser.yy"
+#line 147 "lib/parser.yy"
                                         { yylhs.value.as < std::string > () = "int32"; }
-#line 719 "lib/parser.cpp"
+#line 720 "lib/parser.cpp"
     break;
 
   case 17: // type: "bool"
-#line 147 "lib/parser.yy"
+#line 148 "lib/parser.yy"
                                        { yylhs.value.as < std::string > () = "bool"; }
-#line 725 "lib/parser.cpp"
+#line 726 "lib/parser.cpp"
     break;
 
   case 18: // type: "string"
-#line 148 "lib/parser.yy"
+#line 149 "lib/parser.yy"
                                          { yylhs.value.as < std::string > () = "string"; }
-#line 731 "lib/parser.cpp"
+#line 732 "lib/parser.cpp"
     break;
 
   case 19: // type: "unit"
-#line 149 "lib/parser.yy"
+#line 150 "lib/parser.yy"
                                        { yylhs.value.as < std::string > () = "unit"; }
-#line 737 "lib/parser.cpp"
+#line 738 "lib/parser.cpp"
     break;
 
   case 22: // formal: form
-#line 154 "lib/parser.yy"
-                             { formals_vec[ctx].push_back(yystack_[0].value.as < Node > ()); }
-#line 743 "lib/parser.cpp"
+#line 155 "lib/parser.yy"
+                             { formals_vec[ctx].push_back(std::move(yystack_[0].value.as < Node > ())); }
+#line 744 "lib/parser.cpp"
     break;
 
   case 23: // formal: formal "," form
-#line 155 "lib/parser.yy"
-                                                { formals_vec[ctx].push_back(yystack_[0].value.as < Node > ()); }
-#line 749 "lib/parser.cpp"
+#line 156 "lib/parser.yy"
+                                                { formals_vec[ctx].push_back(std::move(yystack_[0].value.as < Node > ())); }
+#line 750 "lib/parser.cpp"
     break;
 
   case 24: // form: OBJ_ID ":" type
-#line 157 "lib/parser.yy"
+#line 158 "lib/parser.yy"
                                         {yylhs.value.as < Node > () = Node::create_formal(yystack_[2].location.begin.line, yystack_[2].location.begin.column, yystack_[2].value.as < std::string > (), yystack_[0].value.as < std::string > ()); }
-#line 755 "lib/parser.cpp"
+#line 756 "lib/parser.cpp"
     break;
 
   case 25: // $@3: %empty
-#line 159 "lib/parser.yy"
+#line 160 "lib/parser.yy"
                             { push_ctx(); }
-#line 761 "lib/parser.cpp"
+#line 762 "lib/parser.cpp"
     break;
 
   case 26: // block: "{" $@3 exprs "}"
-#line 159 "lib/parser.yy"
-                                                      { yylhs.value.as < Node > () = Node::create_block(yystack_[3].location.begin.line, yystack_[3].location.begin.column, block_vec[ctx]); pop_ctx(); }
-#line 767 "lib/parser.cpp"
+#line 160 "lib/parser.yy"
+                                                      { yylhs.value.as < Node > () = Node::create_block(yystack_[3].location.begin.line, yystack_[3].location.begin.column, std::move(block_vec[ctx])); pop_ctx(); }
+#line 768 "lib/parser.cpp"
     break;
 
   case 27: // exprs: expr
-#line 161 "lib/parser.yy"
-                             { block_vec[ctx].push_back(yystack_[0].value.as < Node > ()); }
-#line 773 "lib/parser.cpp"
+#line 162 "lib/parser.yy"
+                             { block_vec[ctx].push_back(std::move(yystack_[0].value.as < Node > ())); }
+#line 774 "lib/parser.cpp"
     break;
 
   case 28: // exprs: exprs ";" expr
-#line 162 "lib/parser.yy"
-                                               { block_vec[ctx].push_back(yystack_[0].value.as < Node > ()); }
-#line 779 "lib/parser.cpp"
+#line 163 "lib/parser.yy"
+                                               { block_vec[ctx].push_back(std::move(yystack_[0].value.as < Node > ())); }
+#line 780 "lib/parser.cpp"
     break;
 
   case 29: // expr: "if" expr "then" expr
-#line 164 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = Node::create_if_expr(yystack_[3].location.begin.line, yystack_[3].location.begin.column, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 785 "lib/parser.cpp"
+#line 165 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = Node::create_if_expr(yystack_[3].location.begin.line, yystack_[3].location.begin.column, std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 786 "lib/parser.cpp"
     break;
 
   case 30: // expr: "if" expr "then" expr "else" expr
-#line 165 "lib/parser.yy"
-                                                          { yylhs.value.as < Node > () = Node::create_if_expr(yystack_[5].location.begin.line, yystack_[5].location.begin.column, yystack_[4].value.as < Node > (), yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 791 "lib/parser.cpp"
+#line 166 "lib/parser.yy"
+                                                          { yylhs.value.as < Node > () = Node::create_if_expr(yystack_[5].location.begin.line, yystack_[5].location.begin.column, std::move(yystack_[4].value.as < Node > ()), std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 792 "lib/parser.cpp"
     break;
 
   case 31: // expr: "while" expr "do" expr
-#line 166 "lib/parser.yy"
-                                                       { yylhs.value.as < Node > () = Node::create_while_expr(yystack_[3].location.begin.line, yystack_[3].location.begin.column, yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 797 "lib/parser.cpp"
+#line 167 "lib/parser.yy"
+                                                       { yylhs.value.as < Node > () = Node::create_while_expr(yystack_[3].location.begin.line, yystack_[3].location.begin.column, std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 798 "lib/parser.cpp"
     break;
 
   case 32: // expr: "let" OBJ_ID ":" type "in" expr
-#line 167 "lib/parser.yy"
-                                                                { yylhs.value.as < Node > () = Node::create_let_expr(yystack_[5].location.begin.line, yystack_[5].location.begin.column, yystack_[4].value.as < std::string > (), yystack_[2].value.as < std::string > (), yystack_[0].value.as < Node > ()); }
-#line 803 "lib/parser.cpp"
+#line 168 "lib/parser.yy"
+                                                                { yylhs.value.as < Node > () = Node::create_let_expr(yystack_[5].location.begin.line, yystack_[5].location.begin.column, yystack_[4].value.as < std::string > (), yystack_[2].value.as < std::string > (), std::move(yystack_[0].value.as < Node > ())); }
+#line 804 "lib/parser.cpp"
     break;
 
   case 33: // expr: "let" OBJ_ID ":" type "<-" expr "in" expr
-#line 168 "lib/parser.yy"
-                                                                          { yylhs.value.as < Node > () = Node::create_let_expr(yystack_[7].location.begin.line, yystack_[7].location.begin.column, yystack_[6].value.as < std::string > (), yystack_[4].value.as < std::string > (), yystack_[0].value.as < Node > (), yystack_[2].value.as < Node > ()); }
-#line 809 "lib/parser.cpp"
+#line 169 "lib/parser.yy"
+                                                                          { yylhs.value.as < Node > () = Node::create_let_expr(yystack_[7].location.begin.line, yystack_[7].location.begin.column, yystack_[6].value.as < std::string > (), yystack_[4].value.as < std::string > (), std::move(yystack_[0].value.as < Node > ()), std::move(yystack_[2].value.as < Node > ())); }
+#line 810 "lib/parser.cpp"
     break;
 
   case 34: // expr: OBJ_ID "<-" expr
-#line 169 "lib/parser.yy"
-                                                 { yylhs.value.as < Node > () = Node::create_assign_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, yystack_[2].value.as < std::string > (), yystack_[0].value.as < Node > ()); }
-#line 815 "lib/parser.cpp"
+#line 170 "lib/parser.yy"
+                                                 { yylhs.value.as < Node > () = Node::create_assign_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, yystack_[2].value.as < std::string > (), std::move(yystack_[0].value.as < Node > ())); }
+#line 816 "lib/parser.cpp"
     break;
 
   case 35: // expr: "not" expr
-#line 170 "lib/parser.yy"
-                                           { yylhs.value.as < Node > () = Node::create_unop_expr(yystack_[1].location.begin.line, yystack_[1].location.begin.column, "not", yystack_[0].value.as < Node > ()); }
-#line 821 "lib/parser.cpp"
+#line 171 "lib/parser.yy"
+                                           { yylhs.value.as < Node > () = Node::create_unop_expr(yystack_[1].location.begin.line, yystack_[1].location.begin.column, "not", std::move(yystack_[0].value.as < Node > ())); }
+#line 822 "lib/parser.cpp"
     break;
 
   case 36: // expr: "-" expr
-#line 171 "lib/parser.yy"
-                         { yylhs.value.as < Node > () = Node::create_unop_expr(yystack_[1].location.begin.line, yystack_[1].location.begin.column, "-", yystack_[0].value.as < Node > ()); }
-#line 827 "lib/parser.cpp"
+#line 172 "lib/parser.yy"
+                         { yylhs.value.as < Node > () = Node::create_unop_expr(yystack_[1].location.begin.line, yystack_[1].location.begin.column, "-", std::move(yystack_[0].value.as < Node > ())); }
+#line 828 "lib/parser.cpp"
     break;
 
   case 37: // expr: "isnull" expr
-#line 172 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = Node::create_unop_expr(yystack_[1].location.begin.line, yystack_[1].location.begin.column, "isnull", yystack_[0].value.as < Node > ()); }
-#line 833 "lib/parser.cpp"
+#line 173 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = Node::create_unop_expr(yystack_[1].location.begin.line, yystack_[1].location.begin.column, "isnull", std::move(yystack_[0].value.as < Node > ())); }
+#line 834 "lib/parser.cpp"
     break;
 
   case 38: // expr: expr "and" expr
-#line 173 "lib/parser.yy"
-                                                { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "and", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 839 "lib/parser.cpp"
+#line 174 "lib/parser.yy"
+                                                { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "and", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 840 "lib/parser.cpp"
     break;
 
   case 39: // expr: expr "=" expr
-#line 174 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "=", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 845 "lib/parser.cpp"
+#line 175 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "=", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 846 "lib/parser.cpp"
     break;
 
   case 40: // expr: expr "<" expr
-#line 175 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "<", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 851 "lib/parser.cpp"
+#line 176 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "<", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 852 "lib/parser.cpp"
     break;
 
   case 41: // expr: expr "<=" expr
-#line 176 "lib/parser.yy"
-                                               { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "<=", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 857 "lib/parser.cpp"
+#line 177 "lib/parser.yy"
+                                               { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "<=", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 858 "lib/parser.cpp"
     break;
 
   case 42: // expr: expr "+" expr
-#line 177 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "+", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 863 "lib/parser.cpp"
+#line 178 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "+", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 864 "lib/parser.cpp"
     break;
 
   case 43: // expr: expr "-" expr
-#line 178 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "-", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 869 "lib/parser.cpp"
+#line 179 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "-", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 870 "lib/parser.cpp"
     break;
 
   case 44: // expr: expr "*" expr
-#line 179 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "*", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 875 "lib/parser.cpp"
+#line 180 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "*", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 876 "lib/parser.cpp"
     break;
 
   case 45: // expr: expr "/" expr
-#line 180 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "/", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 881 "lib/parser.cpp"
+#line 181 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "/", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 882 "lib/parser.cpp"
     break;
 
   case 46: // expr: expr "^" expr
-#line 181 "lib/parser.yy"
-                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "^", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 887 "lib/parser.cpp"
+#line 182 "lib/parser.yy"
+                                              { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "^", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 888 "lib/parser.cpp"
     break;
 
   case 47: // expr: expr error expr
-#line 182 "lib/parser.yy"
-                                                { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "ERROR", yystack_[2].value.as < Node > (), yystack_[0].value.as < Node > ()); }
-#line 893 "lib/parser.cpp"
+#line 183 "lib/parser.yy"
+                                                { yylhs.value.as < Node > () = Node::create_binop_expr(yystack_[2].location.begin.line, yystack_[2].location.begin.column, "ERROR", std::move(yystack_[2].value.as < Node > ()), std::move(yystack_[0].value.as < Node > ())); }
+#line 894 "lib/parser.cpp"
     break;
 
   case 48: // $@4: %empty
-#line 183 "lib/parser.yy"
+#line 184 "lib/parser.yy"
                                            { push_ctx(); }
-#line 899 "lib/parser.cpp"
+#line 900 "lib/parser.cpp"
     break;
 
   case 49: // expr: OBJ_ID "(" $@4 args ")"
-#line 183 "lib/parser.yy"
-                                                                    { yylhs.value.as < Node > () = Node::create_call_expr(yystack_[4].location.begin.line, yystack_[4].location.begin.column, Node::create_object_identifier(yystack_[4].location.begin.line, yystack_[4].location.begin.column, "self", cur_clazz), yystack_[4].value.as < std::string > (), args_vec[ctx]); pop_ctx(); }
-#line 905 "lib/parser.cpp"
+#line 184 "lib/parser.yy"
+                                                                    { yylhs.value.as < Node > () = Node::create_call_expr(yystack_[4].location.begin.line, yystack_[4].location.begin.column, Node::create_object_identifier(yystack_[4].location.begin.line, yystack_[4].location.begin.column, "self", cur_clazz), yystack_[4].value.as < std::string > (), std::move(args_vec[ctx])); pop_ctx(); }
+#line 906 "lib/parser.cpp"
     break;
 
   case 50: // $@5: %empty
-#line 184 "lib/parser.yy"
+#line 185 "lib/parser.yy"
                                                     { push_ctx(); }
-#line 911 "lib/parser.cpp"
+#line 912 "lib/parser.cpp"
     break;
 
   case 51: // expr: expr "." OBJ_ID "(" $@5 args ")"
-#line 184 "lib/parser.yy"
-                                                                             { yylhs.value.as < Node > () = Node::create_call_expr(yystack_[6].location.begin.line, yystack_[6].location.begin.column, yystack_[6].value.as < Node > (), yystack_[4].value.as < std::string > (), args_vec[ctx]); pop_ctx(); }
-#line 917 "lib/parser.cpp"
+#line 185 "lib/parser.yy"
+                                                                             { yylhs.value.as < Node > () = Node::create_call_expr(yystack_[6].location.begin.line, yystack_[6].location.begin.column, std::move(yystack_[6].value.as < Node > ()), yystack_[4].value.as < std::string > (), std::move(args_vec[ctx])); pop_ctx(); }
+#line 918 "lib/parser.cpp"
     break;
 
   case 52: // expr: "new" TYPE_ID
-#line 185 "lib/parser.yy"
+#line 186 "lib/parser.yy"
                                               { yylhs.value.as < Node > () = Node::create_new_expr(yystack_[1].location.begin.line, yystack_[1].location.begin.column, yystack_[0].value.as < std::string > ()); }
-#line 923 "lib/parser.cpp"
+#line 924 "lib/parser.cpp"
     break;
 
   case 53: // expr: OBJ_ID
-#line 186 "lib/parser.yy"
+#line 187 "lib/parser.yy"
                                        { yylhs.value.as < Node > () = Node::create_object_identifier(yystack_[0].location.begin.line, yystack_[0].location.begin.column, yystack_[0].value.as < std::string > ()); }
-#line 929 "lib/parser.cpp"
+#line 930 "lib/parser.cpp"
     break;
 
   case 54: // expr: "self"
-#line 187 "lib/parser.yy"
+#line 188 "lib/parser.yy"
                                        { yylhs.value.as < Node > () = Node::create_object_identifier(yystack_[0].location.begin.line, yystack_[0].location.begin.column, "self", cur_clazz); }
-#line 935 "lib/parser.cpp"
+#line 936 "lib/parser.cpp"
     break;
 
   case 55: // expr: literal
-#line 188 "lib/parser.yy"
-                                        { yylhs.value.as < Node > () = yystack_[0].value.as < Node > (); }
-#line 941 "lib/parser.cpp"
+#line 189 "lib/parser.yy"
+                                        { yylhs.value.as < Node > () = std::move(yystack_[0].value.as < Node > ()); }
+#line 942 "lib/parser.cpp"
     break;
 
   case 56: // expr: "(" ")"
-#line 189 "lib/parser.yy"
+#line 190 "lib/parser.yy"
                                         { yylhs.value.as < Node > () = Node::create_unit(yystack_[1].location.begin.line, yystack_[1].location.begin.column); }
-#line 947 "lib/parser.cpp"
+#line 948 "lib/parser.cpp"
     break;
 
   case 57: // expr: "(" expr ")"
-#line 190 "lib/parser.yy"
-                                             { yylhs.value.as < Node > () = yystack_[1].value.as < Node > (); }
-#line 953 "lib/parser.cpp"
+#line 191 "lib/parser.yy"
+                                             { yylhs.value.as < Node > () = std::move(yystack_[1].value.as < Node > ()); }
+#line 954 "lib/parser.cpp"
     break;
 
   case 58: // expr: block
-#line 191 "lib/parser.yy"
-                                      { yylhs.value.as < Node > () = yystack_[0].value.as < Node > (); }
-#line 959 "lib/parser.cpp"
+#line 192 "lib/parser.yy"
+                                      { yylhs.value.as < Node > () = std::move(yystack_[0].value.as < Node > ()); }
+#line 960 "lib/parser.cpp"
     break;
 
   case 61: // arg: expr
-#line 196 "lib/parser.yy"
-                             { args_vec[ctx].push_back(yystack_[0].value.as < Node > ()); }
-#line 965 "lib/parser.cpp"
+#line 197 "lib/parser.yy"
+                             { args_vec[ctx].push_back(std::move(yystack_[0].value.as < Node > ())); }
+#line 966 "lib/parser.cpp"
     break;
 
   case 62: // arg: arg "," expr
-#line 197 "lib/parser.yy"
-                                             { args_vec[ctx].push_back(yystack_[0].value.as < Node > ()); }
-#line 971 "lib/parser.cpp"
+#line 198 "lib/parser.yy"
+                                             { args_vec[ctx].push_back(std::move(yystack_[0].value.as < Node > ())); }
+#line 972 "lib/parser.cpp"
     break;
 
   case 63: // literal: INTEGER_LIT
-#line 199 "lib/parser.yy"
+#line 200 "lib/parser.yy"
                                     { yylhs.value.as < Node > () = Node::create_int32(yystack_[0].location.begin.line, yystack_[0].location.begin.column, yystack_[0].value.as < std::string > ()); }
-#line 977 "lib/parser.cpp"
+#line 978 "lib/parser.cpp"
     break;
 
   case 64: // literal: STRING_LIT
-#line 200 "lib/parser.yy"
+#line 201 "lib/parser.yy"
                                            { yylhs.value.as < Node > () = Node::create_string(yystack_[0].location.begin.line, yystack_[0].location.begin.column, yystack_[0].value.as < std::string > ()); }
-#line 983 "lib/parser.cpp"
+#line 984 "lib/parser.cpp"
     break;
 
   case 65: // literal: boolean
-#line 201 "lib/parser.yy"
+#line 202 "lib/parser.yy"
                                         { yylhs.value.as < Node > () = Node::create_bool(yystack_[0].location.begin.line, yystack_[0].location.begin.column, yystack_[0].value.as < std::string > ()); }
-#line 989 "lib/parser.cpp"
+#line 990 "lib/parser.cpp"
     break;
 
   case 66: // boolean: "true"
-#line 203 "lib/parser.yy"
+#line 204 "lib/parser.yy"
                                { yylhs.value.as < std::string > () = "true"; }
-#line 995 "lib/parser.cpp"
+#line 996 "lib/parser.cpp"
     break;
 
   case 67: // boolean: "false"
-#line 204 "lib/parser.yy"
+#line 205 "lib/parser.yy"
                                         { yylhs.value.as < std::string > () = "false"; }
-#line 1001 "lib/parser.cpp"
+#line 1002 "lib/parser.cpp"
     break;
 
 
-#line 1005 "lib/parser.cpp"
+#line 1006 "lib/parser.cpp"
 
             default:
               break;
@@ -1749,9 +1750,9 @@ namespace yy {
 
 
 } // yy
-#line 1753 "lib/parser.cpp"
+#line 1754 "lib/parser.cpp"
 
-#line 206 "lib/parser.yy"
+#line 207 "lib/parser.yy"
  // End grammar rules
 
 
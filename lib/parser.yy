@@ -32,6 +32,7 @@
 
 %code { 
 	#include <iostream>
+	#include <utility>
 	#include <vector>
 
 	namespace yy { 
@@ -125,22 +126,22 @@
 %start program
 %% // Grammar rules
 
-program : 		clazz { ast = Node::create_program(1, 1, {$1}); }
+program : 		clazz { ast = Node::create_program(1, 1, {}); ast.add_clazz($1); }
 |			 	program clazz { ast.add_clazz($2); }
 
-clazz : 		"class" TYPE_ID { cur_clazz = $2; } clazzbody { $$ = Node::create_clazz(@1.begin.line, @1.begin.column, $2, "Object", fields_vec[ctx], methods_vec[ctx]); fields_vec[ctx].clear(); methods_vec[ctx].clear(); }
-| 				"class" TYPE_ID "extends" TYPE_ID { cur_clazz = $2; } clazzbody { $$ = Node::create_clazz(@1.begin.line, @1.begin.column, $2, $4, fields_vec[ctx], methods_vec[ctx]); fields_vec[ctx].clear(); methods_vec[ctx].clear(); }
+clazz : 		"class" TYPE_ID { cur_clazz = $2; } clazzbody { $$ = Node::create_clazz(@1.begin.line, @1.begin.column, $2, "Object", std::move(fields_vec[ctx]), std::move(methods_vec[ctx])); fields_vec[ctx].clear(); methods_vec[ctx].clear(); }
+| 				"class" TYPE_ID "extends" TYPE_ID { cur_clazz = $2; } clazzbody { $$ = Node::create_clazz(@1.begin.line, @1.begin.column, $2, $4, std::move(fields_vec[ctx]), std::move(methods_vec[ctx])); fields_vec[ctx].clear(); methods_vec[ctx].clear(); }
 
 clazzbody : 	"{" body "}"
 
 body : 			%empty
-|	 			body field { fields_vec[ctx].push_back($2); }
-| 				body method { methods_vec[ctx].push_back($2); }
+|	 			body field { fields_vec[ctx].push_back(std::move($2)); }
+| 				body method { methods_vec[ctx].push_back(std::move($2)); }
 
 field : 		OBJ_ID ":" type ";" { $$ = Node::create_field(@1.begin.line, @1.begin.column, $1, $3); }
-| 				OBJ_ID ":" type "<-" expr ";" { $$ = Node::create_field(@1.begin.line, @1.begin.column, $1, $3, $5); }
+| 				OBJ_ID ":" type "<-" expr ";" { $$ = Node::create_field(@1.begin.line, @1.begin.column, $1, $3, std::move($5)); }
 
-method :		OBJ_ID "(" formals ")" ":" type block { $$ = Node::create_method(@1.begin.line, @1.begin.column, $1, formals_vec[ctx], $6, $7); formals_vec[ctx].clear(); }
+method :		OBJ_ID "(" formals ")" ":" type block { $$ = Node::create_method(@1.begin.line, @1.begin.column, $1, std::move(formals_vec[ctx]), $6, std::move($7)); formals_vec[ctx].clear(); }
 
 type : 			TYPE_ID { $$ = $1; }
 | 				"int32" { $$ = "int32"; }
@@ -151,50 +152,50 @@ type : 			TYPE_ID { $$ = $1; }
 formals :		%empty
 |	 			formal
 
-formal : 		form { formals_vec[ctx].push_back($1); }
-| 				formal "," form { formals_vec[ctx].push_back($3); }
+formal : 		form { formals_vec[ctx].push_back(std::move($1)); }
+| 				formal "," form { formals_vec[ctx].push_back(std::move($3)); }
 
 form : 			OBJ_ID ":" type {$$ = Node::create_formal(@1.begin.line, @1.begin.column, $1, $3); }
 
-block : 		"{" { push_ctx(); } exprs "}" { $$ = Node::create_block(@1.begin.line, @1.begin.column, block_vec[ctx]); pop_ctx(); }
-
-exprs : 		expr { block_vec[ctx].push_back($1); }
-| 				exprs ";" expr { block_vec[ctx].push_back($3); }
-
-expr : 			"if" expr "then" expr { $$ = Node::create_if_expr(@1.begin.line, @1.begin.column, $2, $4); }
-|        		"if" expr "then" expr "else" expr { $$ = Node::create_if_expr(@1.begin.line, @1.begin.column, $2, $4, $6); }
-| 				"while" expr "do" expr { $$ = Node::create_while_expr(@1.begin.line, @1.begin.column, $2, $4); }
-| 				"let" OBJ_ID ":" type "in" expr { $$ = Node::create_let_expr(@1.begin.line, @1.begin.column, $2, $4, $6); }
-| 				"let" OBJ_ID ":" type "<-" expr "in" expr { $$ = Node::create_let_expr(@1.begin.line, @1.begin.column, $2, $4, $8, $6); }
-|				OBJ_ID "<-" expr { $$ = Node::create_assign_expr(@1.begin.line, @1.begin.column, $1, $3); }
-|	 			"not" expr { $$ = Node::create_unop_expr(@1.begin.line, @1.begin.column, "not", $2); }
-|%prec UMIN 	"-" expr { $$ = Node::create_unop_expr(@1.begin.line, @1.begin.column, "-", $2); }
-|	 			"isnull" expr { $$ = Node::create_unop_expr(@1.begin.line, @1.begin.column, "isnull", $2); }
-| 				expr "and" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "and", $1, $3); }
-| 				expr "=" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "=", $1, $3); }
-|	 			expr "<" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "<", $1, $3); }
-| 				expr "<=" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "<=", $1, $3); }
-| 				expr "+" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "+", $1, $3); }
-| 				expr "-" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "-", $1, $3); }
-|	 			expr "*" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "*", $1, $3); }
-| 				expr "/" expr { $$ = $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "/", $1, $3); }
-| 				expr "^" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "^", $1, $3); }
-|				expr error expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "ERROR", $1, $3); }
-|				OBJ_ID "(" { push_ctx(); } args ")" { $$ = Node::create_call_expr(@1.begin.line, @1.begin.column, Node::create_object_identifier(@1.begin.line, @1.begin.column, "self", cur_clazz), $1, args_vec[ctx]); pop_ctx(); }
-| 				expr "." OBJ_ID "(" { push_ctx(); } args ")" { $$ = Node::create_call_expr(@1.begin.line, @1.begin.column, $1, $3, args_vec[ctx]); pop_ctx(); }
+block : 		"{" { push_ctx(); } exprs "}" { $$ = Node::create_block(@1.begin.line, @1.begin.column, std::move(block_vec[ctx])); pop_ctx(); }
+
+exprs : 		expr { block_vec[ctx].push_back(std::move($1)); }
+| 				exprs ";" expr { block_vec[ctx].push_back(std::move($3)); }
+
+expr : 			"if" expr "then" expr { $$ = Node::create_if_expr(@1.begin.line, @1.begin.column, std::move($2), std::move($4)); }
+|        		"if" expr "then" expr "else" expr { $$ = Node::create_if_expr(@1.begin.line, @1.begin.column, std::move($2), std::move($4), std::move($6)); }
+| 				"while" expr "do" expr { $$ = Node::create_while_expr(@1.begin.line, @1.begin.column, std::move($2), std::move($4)); }
+| 				"let" OBJ_ID ":" type "in" expr { $$ = Node::create_let_expr(@1.begin.line, @1.begin.column, $2, $4, std::move($6)); }
+| 				"let" OBJ_ID ":" type "<-" expr "in" expr { $$ = Node::create_let_expr(@1.begin.line, @1.begin.column, $2, $4, std::move($8), std::move($6)); }
+|				OBJ_ID "<-" expr { $$ = Node::create_assign_expr(@1.begin.line, @1.begin.column, $1, std::move($3)); }
+|	 			"not" expr { $$ = Node::create_unop_expr(@1.begin.line, @1.begin.column, "not", std::move($2)); }
+|%prec UMIN 	"-" expr { $$ = Node::create_unop_expr(@1.begin.line, @1.begin.column, "-", std::move($2)); }
+|	 			"isnull" expr { $$ = Node::create_unop_expr(@1.begin.line, @1.begin.column, "isnull", std::move($2)); }
+| 				expr "and" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "and", std::move($1), std::move($3)); }
+| 				expr "=" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "=", std::move($1), std::move($3)); }
+|	 			expr "<" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "<", std::move($1), std::move($3)); }
+| 				expr "<=" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "<=", std::move($1), std::move($3)); }
+| 				expr "+" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "+", std::move($1), std::move($3)); }
+| 				expr "-" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "-", std::move($1), std::move($3)); }
+|	 			expr "*" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "*", std::move($1), std::move($3)); }
+| 				expr "/" expr { $$ = $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "/", std::move($1), std::move($3)); }
+| 				expr "^" expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "^", std::move($1), std::move($3)); }
+|				expr error expr { $$ = Node::create_binop_expr(@1.begin.line, @1.begin.column, "ERROR", std::move($1), std::move($3)); }
+|				OBJ_ID "(" { push_ctx(); } args ")" { $$ = Node::create_call_expr(@1.begin.line, @1.begin.column, Node::create_object_identifier(@1.begin.line, @1.begin.column, "self", cur_clazz), $1, std::move(args_vec[ctx])); pop_ctx(); }
+| 				expr "." OBJ_ID "(" { push_ctx(); } args ")" { $$ = Node::create_call_expr(@1.begin.line, @1.begin.column, std::move($1), $3, std::move(args_vec[ctx])); pop_ctx(); }
 | 				"new" TYPE_ID { $$ = Node::create_new_expr(@1.begin.line, @1.begin.column, $2); }
 |	 			OBJ_ID { $$ = Node::create_object_identifier(@1.begin.line, @1.begin.column, $1); }
 | 				"self" { $$ = Node::create_object_identifier(@1.begin.line, @1.begin.column, "self", cur_clazz); }
-| 				literal { $$ = $1; }
+| 				literal { $$ = std::move($1); }
 | 				"(" ")" { $$ = Node::create_unit(@1.begin.line, @1.begin.column); }
-|	 			"(" expr ")" { $$ = $2; }
-| 				block { $$ = $1; }
+|	 			"(" expr ")" { $$ = std::move($2); }
+| 				block { $$ = std::move($1); }
 
 args : 			%empty
 | 				arg
 
-arg : 			expr { args_vec[ctx].push_back($1); }
-| 				arg "," expr { args_vec[ctx].push_back($3); }
+arg : 			expr { args_vec[ctx].push_back(std::move($1)); }
+| 				arg "," expr { args_vec[ctx].push_back(std::move($3)); }
 
 literal : 		INTEGER_LIT { $$ = Node::create_int32(@1.begin.line, @1.begin.column, $1); }
 | 				STRING_LIT { $$ = Node::create_string(@1.begin.line, @1.begin.column, $1); }
@@ -0,0 +1,47 @@
+/*
+ * scope.cpp
+ *
+ * by Antoine Boonen
+ *
+ * This file contains the implementation of the Scope class as described in the interface 'scope.h'.
+ *
+ * Created   19/10/26
+ * Modified  19/10/26
+ */
+#include "scope.hpp"
+
+Scope::Scope() {}
+
+void Scope::push(int symbol, TypeRef type) {
+    if(bindings.size() <= (size_t) symbol) {
+        bindings.resize(symbol + 1);
+    }
+    bindings[symbol].push_back(type);
+    pushed.push_back(symbol);
+}
+
+void Scope::pop() {
+    if(pushed.empty()) {
+        return;
+    }
+
+    bindings[pushed.back()].pop_back();
+    pushed.pop_back();
+}
+
+TypeRef Scope::lookup(int symbol) const {
+    if(symbol < 0 || (size_t) symbol >= bindings.size() || bindings[symbol].empty()) {
+        return TypeRef();
+    }
+    return bindings[symbol].back();
+}
+
+size_t Scope::size() const {
+    return pushed.size();
+}
+
+void Scope::unwind(size_t mark) {
+    while(pushed.size() > mark) {
+        pop();
+    }
+}
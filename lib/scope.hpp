@@ -0,0 +1,82 @@
+/*
+ * scope.h
+ *
+ * by Antoine Boonen
+ *
+ * This file contains the interface of the Scope class.
+ *
+ * Created   19/10/26
+ * Modified  19/10/26
+ */
+#include "type_ref.hpp"
+
+#include <iostream>
+#include <vector>
+
+#ifndef VSOPCOMPILER_SCOPE_H
+#define VSOPCOMPILER_SCOPE_H
+
+class Scope {
+    private:
+        std::vector<std::vector<TypeRef> > bindings; // The stack of types of each variable symbol (innermost last)
+        std::vector<int> pushed; // The bound variable symbols, in binding order
+
+    public:
+        /*
+         * Scope constructor
+         *
+         * return:
+         *      An empty Scope instance.
+         */
+        Scope();
+
+        /*
+         * push
+         *
+         * input:
+         *      symbol - the interned name of the variable to bind (see Node::intern).
+         *      type - the type of the variable.
+         * 
+         * Bind the variable, shadowing any previous binding of the same name.
+         */
+        void push(int symbol, TypeRef type);
+
+        /*
+         * pop
+         *
+         * Remove the last binding pushed.
+         */
+        void pop();
+
+        /*
+         * lookup
+         *
+         * input:
+         *      symbol - the interned name of the wanted variable.
+         * 
+         * return:
+         *      the type of the innermost binding of the variable if any,
+         *      none otherwise.
+         */
+        TypeRef lookup(int symbol) const;
+
+        /*
+         * size
+         *
+         * return:
+         *      the number of bindings, to be used as a mark for unwind.
+         */
+        size_t size() const;
+
+        /*
+         * unwind
+         *
+         * input:
+         *      mark - a previous result of size.
+         * 
+         * Pop the bindings until only mark bindings remain.
+         */
+        void unwind(size_t mark);
+};
+
+#endif //VSOPCOMPILER_SCOPE_H
@@ -0,0 +1,207 @@
+/*
+ * stack_allocation.cpp
+ *
+ * by Antoine Boonen
+ *
+ * This file contains the implementation of the StackAllocation pass as described in the interface 'stack_allocation.h'.
+ *
+ * Created   19/10/26
+ * Modified  19/10/26
+ */
+#include "stack_allocation.hpp"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "llvm/Analysis/CaptureTracking.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+
+#define _MALLOC "malloc"
+#define MAX_SIZE 1024 // The largest object moved to the stack, in bytes
+#define ALIGNMENT 16 // The alignment of malloc
+
+std::atomic<size_t> StackAllocation::allocations(0);
+
+/*
+ * ObjectTracker
+ *
+ * Follows the uses of one pointer to an object. Passing the object to a method which only gives it back
+ * (as the 'init' methods returning self) does not let it escape, but the result of the call is the object too.
+ */
+class ObjectTracker : public llvm::CaptureTracker {
+    private:
+        StackAllocation &pass; // The pass, which knows the parameters only given back
+        bool returns; // true if returning the object does not let it escape
+    public:
+        bool escaped = false; // true if the object may outlive the call of the function
+        bool carried = false; // true if the object may flow through a phi or a select
+        std::vector<const llvm::Value * > aliases; // The results of the calls that may give the object back
+        std::vector<llvm::CallInst * > tails; // The tail calls the object is passed to
+
+        ObjectTracker(StackAllocation &p, bool r) : pass(p), returns(r) {}
+
+        void tooManyUses() override {
+            escaped = true;
+        }
+
+        bool shouldExplore(const llvm::Use *use) override {
+            if(llvm::isa<llvm::PHINode>(use->getUser()) || llvm::isa<llvm::SelectInst>(use->getUser())) {
+                carried = true;
+            }
+
+            // A tail call may reuse the frame of the caller, and a slot in it
+            auto call = llvm::dyn_cast<llvm::CallInst>(use->getUser());
+            if(call != nullptr && call->isTailCall()) {
+                tails.push_back(call);
+            }
+            return true;
+        }
+
+        bool captured(const llvm::Use *use) override {
+            if(returns && llvm::isa<llvm::ReturnInst>(use->getUser())) {
+                return false;
+            }
+
+            // Comparing the object, as 'init' with null, does not keep it
+            if(llvm::isa<llvm::ICmpInst>(use->getUser())) {
+                return false;
+            }
+
+            auto call = llvm::dyn_cast<llvm::CallBase>(use->getUser());
+            if(call != nullptr && call->isArgOperand(use)) {
+                const llvm::Function *callee = call->getCalledFunction();
+                unsigned index = call->getArgOperandNo(use);
+                if(callee != nullptr && !callee->isDeclaration() && index < callee->arg_size() 
+                    && callee->getArg(index)->getType()->isPointerTy() && pass.is_given_back(callee, index)) {
+                    if(call->getType()->isPointerTy()) {
+                        aliases.push_back(call);
+                    }
+                    return false;
+                }
+            }
+
+            escaped = true;
+            return true;
+        }
+};
+
+bool StackAllocation::escapes(const llvm::Value *object, bool returns, bool &carried, std::vector<llvm::CallInst * > &tails) {
+    std::set<const llvm::Value * > visited = {object};
+    std::vector<const llvm::Value * > pending = {object};
+    while(!pending.empty()) {
+        const llvm::Value *value = pending.back();
+        pending.pop_back();
+
+        ObjectTracker tracker(*this, returns);
+        llvm::PointerMayBeCaptured(value, &tracker);
+        if(tracker.escaped) {
+            return true;
+        }
+        carried = carried || tracker.carried;
+        tails.insert(tails.end(), tracker.tails.begin(), tracker.tails.end());
+
+        for(auto alias : tracker.aliases) {
+            if(visited.insert(alias).second) {
+                pending.push_back(alias);
+            }
+        }
+    }
+    return false;
+}
+
+bool StackAllocation::is_given_back(const llvm::Function *function, unsigned index) {
+    Parameter parameter(function, index);
+    auto known = given_back.find(parameter);
+    if(known != given_back.end()) {
+        return known->second;
+    }
+
+    // Assume a direct recursive call does not let the parameter escape, but not a longer cycle
+    if(!analysing.empty() && analysing.back() == parameter) {
+        return true;
+    }
+    if(std::find(analysing.begin(), analysing.end(), parameter) != analysing.end()) {
+        return false;
+    }
+
+    analysing.push_back(parameter);
+    bool carried = false;
+    std::vector<llvm::CallInst * > tails; // The object is not in the frame of the function
+    bool result = !escapes(function->getArg(index), true, carried, tails);
+    analysing.pop_back();
+
+    given_back[parameter] = result;
+    return result;
+}
+
+llvm::PreservedAnalyses StackAllocation::run(llvm::Function &function, llvm::FunctionAnalysisManager &analyses) {
+    llvm::LoopInfo &loops = analyses.getResult<llvm::LoopAnalysis>(function);
+    given_back.clear();
+
+    std::vector<llvm::CallInst * > candidates;
+    std::vector<llvm::CallInst * > hints; // The tail calls the candidates are passed to
+    for(auto &block : function) {
+        for(auto &instruction : block) {
+            auto call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+            if(call == nullptr || call->getCalledFunction() == nullptr || call->getCalledFunction()->getName() != _MALLOC) {
+                continue;
+            }
+            auto size = llvm::dyn_cast<llvm::ConstantInt>(call->getArgOperand(0));
+            if(size == nullptr || size->getZExtValue() > MAX_SIZE) {
+                continue;
+            }
+
+            // The object escapes if it is stored, returned or passed to a call that may keep it
+            bool carried = false;
+            std::vector<llvm::CallInst * > tails;
+            if(escapes(call, false, carried, tails)) {
+                continue;
+            }
+
+            // The object cannot be in a frame that a guaranteed tail call reuses, other tail calls are only hints
+            if(std::any_of(tails.begin(), tails.end(), [](llvm::CallInst *tail) { return tail->isMustTailCall(); })) {
+                continue;
+            }
+            hints.insert(hints.end(), tails.begin(), tails.end());
+
+            // In a loop, a single slot can only hold the object of each iteration if they never meet
+            if(carried && loops.getLoopFor(&block) != nullptr) {
+                continue;
+            }
+            candidates.push_back(call);
+        }
+    }
+
+    if(candidates.empty()) {
+        return llvm::PreservedAnalyses::all();
+    }
+
+    // One slot per object in the entry block, initialized where the object was allocated
+    llvm::BasicBlock &entry = function.getEntryBlock();
+    llvm::IRBuilder<> builder(function.getContext());
+    for(auto call : candidates) {
+        builder.SetInsertPoint(&entry, entry.getFirstInsertionPt()); // The previous one may have been a candidate
+        uint64_t size = llvm::cast<llvm::ConstantInt>(call->getArgOperand(0))->getZExtValue();
+        auto slot = builder.CreateAlloca(llvm::ArrayType::get(builder.getInt8Ty(), size), nullptr, "object");
+        slot->setAlignment(llvm::Align(ALIGNMENT));
+
+        call->replaceAllUsesWith(builder.CreatePointerCast(slot, call->getType()));
+        call->eraseFromParent();
+    }
+    for(auto tail : hints) {
+        tail->setTailCallKind(llvm::CallInst::TCK_None);
+    }
+    allocations += candidates.size();
+
+    llvm::PreservedAnalyses preserved;
+    preserved.preserveSet<llvm::CFGAnalyses>();
+    return preserved;
+}
+
+size_t StackAllocation::get_allocations() {
+    return allocations;
+}
@@ -0,0 +1,94 @@
+/*
+ * stack_allocation.h
+ *
+ * by Antoine Boonen
+ *
+ * This file contains the interface of the StackAllocation pass, which moves the objects that do not escape
+ * their function from the heap to its stack frame.
+ *
+ * Created   19/10/26
+ * Modified  19/10/26
+ */
+
+#include <atomic>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/PassManager.h"
+
+#ifndef VSOPCOMPILER_STACK_ALLOCATION_H
+#define VSOPCOMPILER_STACK_ALLOCATION_H
+
+/*
+ * StackAllocation
+ *
+ * Intraprocedural escape analysis, once the 'new' and 'init' functions have been inlined. The methods called
+ * on an object are only summarized: whether they keep it, or at most give it back (as 'init' returning self).
+ * VSOP never frees an object, so an object which does not outlive the call of its function can live in its frame.
+ */
+class StackAllocation : public llvm::PassInfoMixin<StackAllocation> {
+    private:
+        typedef std::pair<const llvm::Function *, unsigned> Parameter; // A function and the index of one of its parameters
+
+        static std::atomic<size_t> allocations; // The number of allocations moved to the stack, over all the modules
+        std::map<Parameter, bool> given_back; // Whether each parameter analysed escapes only through the return value
+        std::vector<Parameter> analysing; // The parameters being analysed, the innermost last
+
+        /*
+         * escapes
+         *
+         * input:
+         *      object - a pointer to an object.
+         *      returns - true if returning the object does not let it escape.
+         *      carried - set to true if the object may flow through a phi or a select.
+         *      tails - filled with the tail calls the object is passed to.
+         *
+         * return:
+         *      true if the object may outlive the call of the function using it,
+         *      false otherwise.
+         */
+        bool escapes(const llvm::Value *object, bool returns, bool &carried, std::vector<llvm::CallInst * > &tails);
+
+    public:
+        /*
+         * run
+         *
+         * input:
+         *      function - the function whose allocations are analysed.
+         *      analyses - the function analysis manager.
+         *
+         * Replace each 'malloc' of a constant size whose object does not escape by a slot in the entry block.
+         * In a loop, the object of an iteration must not flow to the next one. The object is still initialized
+         * where it was allocated, and the slot can then be scalar replaced.
+         *
+         * return:
+         *      the analyses preserved.
+         */
+        llvm::PreservedAnalyses run(llvm::Function &function, llvm::FunctionAnalysisManager &analyses);
+
+        /*
+         * is_given_back
+         *
+         * input:
+         *      function - a function with a body.
+         *      index - the index of one of its pointer parameters.
+         *
+         * return:
+         *      true if the parameter escapes at most through the return value,
+         *      false otherwise.
+         */
+        bool is_given_back(const llvm::Function *function, unsigned index);
+
+        /*
+         * get_allocations
+         *
+         * return:
+         *      the number of allocations moved to the stack so far.
+         */
+        static size_t get_allocations();
+};
+
+#endif //VSOPCOMPILER_STACK_ALLOCATION_H
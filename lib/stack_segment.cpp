@@ -0,0 +1,213 @@
+/*
+ * stack_segment.cpp
+ *
+ * by Antoine Boonen
+ *
+ * This file contains the implementation of the StackSegment class as described in the interface 'stack_segment.h'.
+ *
+ * Created   19/10/26
+ * Modified  19/10/26
+ */
+#include "stack_segment.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+
+const size_t StackSegment::SEGMENT_SIZE = 16 << 20;
+const size_t StackSegment::SEGMENT_USE = 4 << 20;
+thread_local uintptr_t StackSegment::top = 0;
+thread_local size_t StackSegment::budget = 0;
+
+/*
+ * Segment
+ *
+ * A thread with a SEGMENT_SIZE stack, running the calls it is given one at a time.
+ */
+struct Segment {
+    pthread_t thread; // The thread of the segment
+    bool running; // true if the thread could be created
+    std::mutex mutex; // Guards the fields below
+    std::condition_variable changed; // Notified when a call is given, returns or the segment stops
+    const std::function<void()> *f; // The call to run, nullptr once it has returned
+    std::exception_ptr error; // The exception thrown by f, if any
+    bool stopping; // true once the owner exits
+
+    /*
+     * Segment constructor
+     *
+     * input:
+     *      size - the size of the stack of the thread.
+     *
+     * Start the thread, if possible.
+     */
+    Segment(size_t size);
+
+    /*
+     * Segment destructor
+     *
+     * Stop the thread and wait for it, along with the segment it grew.
+     */
+    ~Segment();
+};
+
+/*
+ * run_segment
+ *
+ * input:
+ *      arg - the Segment to serve.
+ *
+ * The entry point of a new segment: run the calls given until the segment stops.
+ *
+ * return:
+ *      nullptr.
+ */
+static void *run_segment(void *arg) {
+    Segment *segment = (Segment *) arg;
+    std::unique_lock<std::mutex> lock(segment->mutex);
+
+    while(true) {
+        segment->changed.wait(lock, [segment]() {
+            return segment->f != nullptr || segment->stopping;
+        });
+        if(segment->f == nullptr) {
+            return nullptr;
+        }
+
+        lock.unlock();
+        try {
+            (*segment->f)();
+        } catch(...) {
+            segment->error = std::current_exception();
+        }
+        lock.lock();
+
+        segment->f = nullptr;
+        segment->changed.notify_all();
+    }
+}
+
+Segment::Segment(size_t size) {
+    pthread_attr_t attr;
+
+    f = nullptr;
+    stopping = false;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, size);
+    running = (pthread_create(&thread, &attr, run_segment, this) == 0);
+    pthread_attr_destroy(&attr);
+}
+
+Segment::~Segment() {
+    if(!running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    pthread_join(thread, nullptr);
+}
+
+/*
+ * stack_size
+ *
+ * return:
+ *      the size of the stack of the current thread, 0 if unknown.
+ */
+static size_t stack_size() {
+#ifdef __APPLE__
+    return pthread_get_stacksize_np(pthread_self());
+#else
+    pthread_attr_t attr;
+    size_t size = 0;
+
+    if(pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstacksize(&attr, &size);
+        pthread_attr_destroy(&attr);
+    }
+    return size;
+#endif
+}
+
+/*
+ * SegmentOwner
+ *
+ * Destroys the segment of its thread when the thread exits.
+ */
+struct SegmentOwner {
+    ~SegmentOwner();
+};
+
+static thread_local Segment *segment = nullptr; // The segment grown by the current thread, if any
+static thread_local bool released = false; // true once the thread has destroyed its segment, as it exits
+static thread_local SegmentOwner owner; // Destroys segment
+
+SegmentOwner::~SegmentOwner() {
+    delete segment;
+    segment = nullptr;
+    released = true;
+}
+
+bool StackSegment::is_exhausted() {
+    char here;
+    uintptr_t address = (uintptr_t) &here;
+
+    // The stack grows downwards
+    if(top == 0 || address > top) {
+        if(budget == 0) {
+            // Half of the stack, the other half being left to the callers and callees
+            size_t size = stack_size();
+            budget = (size == 0) ? SEGMENT_USE : std::min(SEGMENT_USE, size / 2);
+        }
+        top = address;
+        return false;
+    }
+    return top - address > budget;
+}
+
+void StackSegment::grow(const std::function<void()> &f) {
+    // Create the segment on first use, it lives as long as the current thread
+    if(segment == nullptr && !released) {
+        std::unique_ptr<Segment> created(new Segment(SEGMENT_SIZE));
+        if(created->running) {
+            (void) &owner; // Registers the destructor of owner
+            segment = created.release();
+        }
+    }
+
+    // Once the thread has released its segment (a global AST destroyed at exit), a segment per call
+    std::unique_ptr<Segment> once;
+    Segment *target = segment;
+    if(target == nullptr) {
+        once.reset(new Segment(SEGMENT_SIZE));
+        target = once.get();
+    }
+    if(!target->running) {
+        f(); // No new segment, go on with the current one
+        return;
+    }
+
+    // Give the call to the segment and wait for it to return
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(target->mutex);
+        target->f = &f;
+        target->error = nullptr;
+        target->changed.notify_all();
+        target->changed.wait(lock, [target]() {
+            return target->f == nullptr;
+        });
+        error = target->error;
+    }
+
+    if(error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * stack_segment.h
+ *
+ * by Antoine Boonen
+ *
+ * This file contains the interface of the StackSegment class.
+ *
+ * Created   19/10/26
+ * Modified  19/10/26
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#ifndef VSOPCOMPILER_STACK_SEGMENT_H
+#define VSOPCOMPILER_STACK_SEGMENT_H
+
+/*
+ * StackSegment
+ *
+ * Bounded recursion for the traversals of the AST: once a traversal has used its budget of the
+ * current stack (half of the stack, at most SEGMENT_USE bytes), its next recursive call runs on
+ * a new segment. The depth of an AST is then only bounded by the memory, about SEGMENT_USE per
+ * segment in use. Each thread keeps the segment it grew, so that the siblings of a node at the
+ * boundary run on the same segment one after the other.
+ */
+class StackSegment {
+    private:
+        static const size_t SEGMENT_SIZE; // The size of a new segment
+        static const size_t SEGMENT_USE; // The stack a traversal may use on a segment, the rest is left to callees
+        static thread_local uintptr_t top; // The shallowest address seen on the current segment, 0 if none
+        static thread_local size_t budget; // The stack a traversal may use on the current thread
+
+    public:
+        /*
+         * is_exhausted
+         *
+         * return:
+         *      true if the traversal has used its budget of the current segment,
+         *      false otherwise.
+         */
+        static bool is_exhausted();
+
+        /*
+         * grow
+         *
+         * input:
+         *      f - the recursive call to run.
+         *
+         * Run f on the segment of the current thread, created on first use, and wait for it
+         * to return. An exception thrown by f is rethrown.
+         */
+        static void grow(const std::function<void()> &f);
+};
+
+#endif //VSOPCOMPILER_STACK_SEGMENT_H
@@ -29,8 +29,10 @@ SymbolTable* SymbolTable::getInstance() {
 }
 
 SymbolTable::SymbolTable() {
+    frozen = false;
+
     // Add Object class and methods to the list of symbols
-    Node object = Node::create_clazz(0, 0, "Object", "Object", {}, {
+    object = Node::create_clazz(0, 0, "Object", "Object", {}, {
         Node::create_method(0, 0, "print", 
             {Node::create_formal(0, 0, "s", "string")}, "Object", 
             {Node::create_block(0, 0, {})}),
@@ -50,168 +52,379 @@ SymbolTable::SymbolTable() {
     std::string obj_type = std::string("Object");
     object.set_return_type(obj_type);
 
-    clazz_definition["Object"] = object;
+    // Object is always the clazz number 0, its methods only use primitive types besides
+    object.set_type_ref(TypeRef::clazz(0));
+    for(auto &method : object.get_children(NodeType::method)) {
+        std::string type = method.get_data(DataType::type);
+        method.set_type_ref((type == obj_type) ? TypeRef::clazz(0) : TypeRef::of_primitive(type));
+
+        for(auto &formal : method.get_children(NodeType::formal)) {
+            formal.set_type_ref(TypeRef::of_primitive(formal.get_data(DataType::type)));
+        }
+    }
+
+    clear();
+}
+
+void SymbolTable::clear() {
+    frozen = false;
+    clazz_definition.clear();
+    clazz_in_cycle.clear();
+    symbol_table.clear();
+    clazz_lookup.clear();
+    hierarchy_children.clear();
+    clazz_index.clear();
+    pre_order.clear();
+    post_order.clear();
+    indexed_clazz.clear();
+    jump.clear();
+    clazz_number.clear();
+    numbered_clazz.clear();
+    field_layout.clear();
+    vtable_layout.clear();
+    field_slot.clear();
+    method_slot.clear();
+    method_overridden.clear();
+
+    clazz_definition["Object"] = &object;
     for(auto &method : object.get_children(NodeType::method)) {
-        symbol_table["Object"][METHOD][method.get_data(DataType::id)] = method;
+        symbol_table["Object"][METHOD][method.get_data(DataType::id)] = &method;
     }
 }
 
-Node SymbolTable::add_clazz_to_definition(Node clazz) {
+const Node *SymbolTable::add_clazz_to_definition(const Node &clazz) {
     std::string id = clazz.get_data(DataType::id);
 
-    if(!clazz_definition[id].is_empty()) { // class already defined
-        return clazz_definition[id];
+    const Node *defined = lookup_clazz(id);
+    if(defined != nullptr) { // class already defined
+        return defined;
     }
 
-    clazz_definition[id] = clazz;
+    clazz_definition[id] = &clazz;
 
-    return Node();
+    return nullptr;
 }
 
 int SymbolTable::cyclic_clazz_definition() {
     clazz_in_cycle.clear();
+    hierarchy_children.clear();
+
+    // Colour of each clazz: absent (unvisited), on the current path or resolved
+    enum class Colour { path, rooted, cyclic, dangling };
+    std::unordered_map<std::string, Colour> colour;
+    std::vector<std::string> path;
 
-    std::vector<std::string> to_check;
     for(auto &clazz : clazz_definition) {
-        to_check.push_back(clazz.first);
-    }
+        if(clazz.first.compare("Object") == 0 || clazz.second == nullptr || colour.count(clazz.first) != 0) {
+            continue;
+        }
 
-    for(auto &clazz : to_check) {
-        std::map<std::string, bool> in_stack = std::map<std::string, bool>();
+        // Follow the parents until Object, an undefined class, a resolved clazz or the current path (cycle)
+        Colour outcome;
+        std::string cur = clazz.first;
+        path.clear();
+        while(true) {
+            if(cur.compare("Object") == 0) {
+                outcome = Colour::rooted;
+                break;
+            }
 
-        std::string cur = clazz;
-        // Loop until object (no cycle), or cur has already been iterated (cycle)
-        while(cur.compare("Object") != 0 && in_stack[cur] == false/* && std::find(to_check.begin(), to_check.end(), cur) != to_check.end()*/) {
+            auto def = clazz_definition.find(cur);
+            if(def == clazz_definition.end() || def->second == nullptr) {
+                outcome = Colour::dangling;
+                break;
+            }
 
-            in_stack[cur] = true;
-            cur = clazz_definition[cur].get_data(DataType::parent_id);
+            auto c = colour.find(cur);
+            if(c != colour.end()) {
+                outcome = (c->second == Colour::path) ? Colour::cyclic : c->second;
+                break;
+            }
+
+            colour[cur] = Colour::path;
+            path.push_back(cur);
+            cur = def->second->get_data(DataType::parent_id);
         }
 
-        if(cur.compare("Object") != 0 && in_stack[cur] == true) {
-            // Cycle is present
-            for(auto &node : in_stack) {
-                clazz_in_cycle.push_back(clazz_definition[node.first]);
-                to_check.erase(std::remove(to_check.begin(), to_check.end(), node.first), to_check.end());
+        // Every clazz of the path is in a cycle or references one if the outcome is a cycle
+        for(auto &id : path) {
+            colour[id] = outcome;
+
+            const Node *node = clazz_definition[id];
+            if(outcome == Colour::cyclic) {
+                clazz_in_cycle.push_back(node);
+            } else if(outcome == Colour::rooted) {
+                hierarchy_children[node->get_data(DataType::parent_id)].push_back(id);
             }
-        } 
+        }
     }
     return clazz_in_cycle.empty() ? 0 : -1;
 }
 
-std::vector<Node> SymbolTable::get_undefined_parents() {
-    std::vector<Node> undef;
+void SymbolTable::build_hierarchy() {
+    clazz_index.clear();
+    pre_order.clear();
+    post_order.clear();
+    indexed_clazz.clear();
+    jump.clear();
+
+    // Iterative DFS from Object over the clazzes resolved by cyclic_clazz_definition
+    int counter = 0;
+    size_t height = 0;
+    std::vector<int> parent_index = {0};
+    std::vector<std::pair<std::string, size_t> > stack = {{"Object", 0}};
+    clazz_index["Object"] = 0;
+    indexed_clazz.push_back("Object");
+    pre_order.push_back(counter++);
+    post_order.push_back(0);
+
+    while(!stack.empty()) {
+        std::string cur = stack.back().first;
+        size_t next = stack.back().second++;
+        std::vector<std::string> &sub = hierarchy_children[cur];
+
+        if(next < sub.size()) {
+            clazz_index[sub[next]] = indexed_clazz.size();
+            indexed_clazz.push_back(sub[next]);
+            parent_index.push_back(clazz_index[cur]);
+            pre_order.push_back(counter++);
+            post_order.push_back(0);
+            stack.emplace_back(sub[next], 0);
+            height = std::max(height, stack.size());
+        } else {
+            post_order[clazz_index[cur]] = counter++;
+            stack.pop_back();
+        }
+    }
 
+    // Binary lifting table, Object being its own parent
+    jump.push_back(parent_index);
+    for(size_t k = 1; ((size_t) 1 << k) < height; ++k) {
+        std::vector<int> &prev = jump.back();
+        std::vector<int> cur(prev.size());
+        for(size_t i = 0; i < prev.size(); ++i) {
+            cur[i] = prev[prev[i]];
+        }
+        jump.push_back(cur);
+    }
+
+    // The clazzes out of the hierarchy (cycle or undefined parent) are numbered after the indexed ones
+    clazz_number = clazz_index;
+    numbered_clazz = indexed_clazz;
     for(auto &clazz : clazz_definition) {
-        std::string parent_clazz = clazz.second.get_data(DataType::parent_id);
-        if(clazz_definition[parent_clazz].is_empty()) {
+        if(clazz.second != nullptr && clazz_number.count(clazz.first) == 0) {
+            clazz_number[clazz.first] = numbered_clazz.size();
+            numbered_clazz.push_back(clazz.first);
+        }
+    }
+}
+
+void SymbolTable::build_layouts() {
+    field_layout.assign(indexed_clazz.size(), std::vector<Member>());
+    vtable_layout.assign(indexed_clazz.size(), std::vector<Member>());
+    field_slot.assign(indexed_clazz.size(), std::unordered_map<std::string, int>());
+    method_slot.assign(indexed_clazz.size(), std::unordered_map<std::string, int>());
+    method_overridden.assign(indexed_clazz.size(), std::vector<bool>());
+
+    // Clazzes are indexed in DFS discovery order, so a parent layout is built before its children ones
+    for(size_t i = 0; i < indexed_clazz.size(); ++i) {
+        std::string id = indexed_clazz[i];
+        const Node &clazz = *clazz_definition.at(id);
+
+        if(i != 0) { // Start from the parent layout (except for Object)
+            int parent = jump[0][i];
+            field_layout[i] = field_layout[parent];
+            vtable_layout[i] = vtable_layout[parent];
+            field_slot[i] = field_slot[parent];
+            method_slot[i] = method_slot[parent];
+        }
+
+        // Fields, in declaration order, after the inherited ones
+        for(auto &field : clazz.get_children(NodeType::field)) {
+            std::string name = field.get_data(DataType::id);
+            if(field_slot[i].count(name) == 0) {
+                field_layout[i].push_back({id, name, lookup_member(id, FIELD, name)});
+                field_slot[i][name] = field_layout[i].size(); // Index 0 is the vtable
+            }
+        }
+
+        // Methods, in declaration order, overriding the inherited ones in place
+        for(auto &method : clazz.get_children(NodeType::method)) {
+            std::string name = method.get_data(DataType::id);
+            auto slot = method_slot[i].find(name);
+
+            if(slot == method_slot[i].end()) {
+                method_slot[i][name] = vtable_layout[i].size();
+                vtable_layout[i].push_back({id, name, lookup_member(id, METHOD, name)});
+            } else {
+                vtable_layout[i][slot->second].owner = id;
+                vtable_layout[i][slot->second].decl = lookup_member(id, METHOD, name);
+
+                // Class hierarchy analysis: the ancestors sharing the slot can no longer bind it statically
+                for(int a = jump[0][i]; (size_t) slot->second < method_overridden[a].size(); a = jump[0][a]) {
+                    method_overridden[a][slot->second] = true;
+                    if(a == 0) {
+                        break;
+                    }
+                }
+            }
+        }
+        method_overridden[i].assign(vtable_layout[i].size(), false);
+    }
+}
+
+void SymbolTable::freeze() {
+    clazz_lookup.clear();
+    for(auto &clazz : clazz_definition) {
+        if(clazz.second != nullptr) {
+            clazz_lookup[clazz.first] = clazz.second;
+        }
+    }
+    frozen = true;
+}
+
+const Node *SymbolTable::lookup_clazz(const std::string &clazz) const {
+    if(frozen) {
+        auto it = clazz_lookup.find(clazz);
+        return (it == clazz_lookup.end()) ? nullptr : it->second;
+    }
+
+    auto it = clazz_definition.find(clazz);
+    return (it == clazz_definition.end()) ? nullptr : it->second;
+}
+
+const Node *SymbolTable::lookup_member(const std::string &clazz, const std::string &kind, const std::string &id) const {
+    auto members = symbol_table.find(clazz);
+    if(members == symbol_table.end()) {
+        return nullptr;
+    }
+
+    auto of_kind = members->second.find(kind);
+    if(of_kind == members->second.end()) {
+        return nullptr;
+    }
+
+    auto member = of_kind->second.find(id);
+    return (member == of_kind->second.end()) ? nullptr : member->second;
+}
+
+std::vector<const Node *> SymbolTable::get_undefined_parents() const {
+    std::vector<const Node *> undef;
+
+    for(auto &clazz : clazz_definition) {
+        if(clazz.first.compare("Object") == 0 || clazz.second == nullptr) {
+            continue;
+        }
+
+        if(lookup_clazz(clazz.second->get_data(DataType::parent_id)) == nullptr) {
             undef.push_back(clazz.second);
         }
     }
     return undef;
 } 
 
-std::vector<Node> SymbolTable::get_cycle() {
+std::vector<const Node *> SymbolTable::get_cycle() const {
     return clazz_in_cycle;
 }
 
-std::vector<Node> SymbolTable::get_defined_clazzes(bool with_Object) {
-    std::vector<Node> clazzes;
+std::vector<const Node *> SymbolTable::get_defined_clazzes(bool with_Object) const {
+    std::vector<const Node *> clazzes;
     for(auto &clazz : clazz_definition) {
-        if(clazz.first.compare("Object") != 0) {
-            clazzes.emplace_back(clazz.second);
+        if(clazz.first.compare("Object") != 0 && clazz.second != nullptr) {
+            clazzes.push_back(clazz.second);
         }
     }
     if(with_Object) {
-        clazzes.emplace_back(clazz_definition["Object"]);
+        clazzes.push_back(&object);
     }
     return clazzes;
 }
 
-Node SymbolTable::get_clazz(std::string clazz) {
-    return clazz_definition[clazz];
+const Node *SymbolTable::get_clazz(std::string clazz) const {
+    return lookup_clazz(clazz);
 }
 
-std::vector<Node> SymbolTable::get_fields_for(std::string clazz) {
-    std::vector<Node> fields;
-    
-    for(auto &field : symbol_table[clazz][FIELD]) {
-        fields.push_back(field.second);
+std::vector<const Node *> SymbolTable::get_fields_for(std::string clazz) const {
+    std::vector<const Node *> fields;
+
+    auto members = symbol_table.find(clazz);
+    if(members != symbol_table.end() && members->second.count(FIELD) != 0) {
+        for(auto &field : members->second.at(FIELD)) {
+            fields.push_back(field.second);
+        }
     }
-    
     return fields;
 }
 
-std::vector<Node> SymbolTable::get_methods_for(std::string clazz) {
-    std::vector<Node> methods;
+std::vector<const Node *> SymbolTable::get_methods_for(std::string clazz) const {
+    std::vector<const Node *> methods;
 
-    for(auto &method : symbol_table[clazz][METHOD]) {
-        methods.push_back(method.second);
+    auto members = symbol_table.find(clazz);
+    if(members != symbol_table.end() && members->second.count(METHOD) != 0) {
+        for(auto &method : members->second.at(METHOD)) {
+            methods.push_back(method.second);
+        }
     }
-    
     return methods;
 }
 
-Node SymbolTable::add_method_to_clazz(std::string clazz, Node n) {
+const Node *SymbolTable::add_method_to_clazz(std::string clazz, const Node &n) {
     std::string name = n.get_data(DataType::id);
 
-    if(!symbol_table[clazz][METHOD][name].is_empty()) {
-        return symbol_table[clazz][METHOD][name];
+    const Node *defined = lookup_member(clazz, METHOD, name);
+    if(defined != nullptr) {
+        return defined;
     }
-    symbol_table[clazz][METHOD][name] = n;
-    return Node();
+    symbol_table[clazz][METHOD][name] = &n;
+    return nullptr;
 }
 
-Node SymbolTable::add_field_to_clazz(std::string clazz, Node n) {
+const Node *SymbolTable::add_field_to_clazz(std::string clazz, const Node &n) {
     std::string name = n.get_data(DataType::id);
 
-    if(!symbol_table[clazz][FIELD][name].is_empty()) {
-        return symbol_table[clazz][FIELD][name];
+    const Node *defined = lookup_member(clazz, FIELD, name);
+    if(defined != nullptr) {
+        return defined;
     }
-    symbol_table[clazz][FIELD][name] = n;
-    return Node();
+    symbol_table[clazz][FIELD][name] = &n;
+    return nullptr;
 }
 
-Node SymbolTable::get_main_method() {
-    if(symbol_table["Main"].empty()) { 
-        // No Main class
-        return Node();
-    }
-    return symbol_table["Main"][METHOD]["main"];
+const Node *SymbolTable::get_main_method() const {
+    return lookup_member("Main", METHOD, "main");
 }
 
-std::vector<std::string> SymbolTable::get_all_ancestors(std::string a) {
-    if(a.empty() || clazz_definition[a].is_empty()) {
+std::vector<std::string> SymbolTable::get_all_ancestors(std::string a) const {
+    const Node *cur = lookup_clazz(a);
+    if(a.empty() || cur == nullptr) {
         return std::vector<std::string>();
     }
 
+    // Loop until Object, an undefined class or the end of a cycle
     std::vector<std::string> ancestors = {a};
-    std::vector<std::string> loop;
-    for(auto &clazz : clazz_in_cycle) {
-        loop.push_back(clazz.get_data(DataType::id));
-    }
-    std::string curr_clazz = a;
-
-    if(loop.empty()) {
-        // Loop until Object if no cycle
-        while(curr_clazz.compare("Object") != 0) {
-            loop.erase(std::remove(loop.begin(), loop.end(), curr_clazz), loop.end());
+    std::unordered_map<std::string, bool> visited = {{a, true}};
+    while(cur != nullptr && ancestors.back().compare("Object") != 0) {
+        std::string parent = cur->get_data(DataType::parent_id);
+        ancestors.push_back(parent);
 
-            curr_clazz = clazz_definition[curr_clazz].get_data(DataType::parent_id);
-            ancestors.push_back(curr_clazz);
-        }
-    } else {
-        // Loop until Object or end of cycle
-        while(curr_clazz.compare("Object") != 0 && loop.size() > 0) {
-            loop.erase(std::remove(loop.begin(), loop.end(), curr_clazz), loop.end());
-
-            curr_clazz = clazz_definition[curr_clazz].get_data(DataType::parent_id);
-            ancestors.push_back(curr_clazz);
+        if(visited[parent]) {
+            break;
         }
-    }    
+        visited[parent] = true;
+        cur = lookup_clazz(parent);
+    }
     return ancestors;
 }
 
-std::string SymbolTable::find_common_ancestor(std::string a, std::string b) {
+std::string SymbolTable::find_common_ancestor(std::string a, std::string b) const {
+    auto index_a = clazz_index.find(a);
+    auto index_b = clazz_index.find(b);
+
+    if(index_a != clazz_index.end() && index_b != clazz_index.end()) {
+        return get_type_name(find_common_ancestor(TypeRef::clazz(index_a->second), TypeRef::clazz(index_b->second)));
+    }
+
+    // Not in the hierarchy (cycle or undefined parent), compare the ancestors
     std::vector<std::string> ancestors_a = get_all_ancestors(a);
     std::vector<std::string> ancestors_b = get_all_ancestors(b);
     
@@ -225,76 +438,219 @@ std::string SymbolTable::find_common_ancestor(std::string a, std::string b) {
     return std::string();
 }
 
-Node SymbolTable::find_field(std::string cur_clazz, std::string id) {
-    std::vector<std::string> ancestors = get_all_ancestors(cur_clazz);
-    Node ret = Node();
+TypeRef SymbolTable::get_type_ref(const std::string &type) const {
+    TypeRef t = TypeRef::of_primitive(type);
+    if(!t.is_none()) {
+        return t;
+    }
 
-    for(auto &anc : ancestors) {
-        ret = symbol_table[anc][FIELD][id];
-        if(!ret.is_empty()) {
-            break;
-        } else {
-            symbol_table[anc][FIELD].erase(id);
+    auto number = clazz_number.find(type);
+    return (number == clazz_number.end()) ? TypeRef() : TypeRef::clazz(number->second);
+}
+
+std::string SymbolTable::get_type_name(TypeRef t) const {
+    if(!t.is_clazz()) {
+        return t.get_primitive_name();
+    }
+    return ((size_t) t.get_clazz() < numbered_clazz.size()) ? numbered_clazz[t.get_clazz()] : std::string();
+}
+
+size_t SymbolTable::get_clazz_count() const {
+    return numbered_clazz.size();
+}
+
+TypeRef SymbolTable::find_common_ancestor(TypeRef a, TypeRef b) const {
+    if(!a.is_clazz() || !b.is_clazz()) {
+        return TypeRef();
+    }
+
+    int u = a.get_clazz();
+    int v = b.get_clazz();
+    if((size_t) u >= indexed_clazz.size() || (size_t) v >= indexed_clazz.size()) {
+        // Not in the hierarchy, compare the ancestors
+        return get_type_ref(find_common_ancestor(get_type_name(a), get_type_name(b)));
+    }
+
+    if(is_ancestor_index(u, v)) {
+        return a;
+    }
+    if(is_ancestor_index(v, u)) {
+        return b;
+    }
+
+    // Climb from u as long as we stay out of v ancestors
+    for(size_t k = jump.size(); k-- > 0;) {
+        if(!is_ancestor_index(jump[k][u], v)) {
+            u = jump[k][u];
         }
     }
-    return ret;
+    return TypeRef::clazz(jump[0][u]);
+}
+
+const std::vector<Member> &SymbolTable::get_field_layout(const std::string &clazz) const {
+    auto index = clazz_index.find(clazz);
+    if(index == clazz_index.end() || (size_t) index->second >= field_layout.size()) {
+        return no_members;
+    }
+    return field_layout[index->second];
+}
+
+const std::vector<Member> &SymbolTable::get_vtable_layout(const std::string &clazz) const {
+    auto index = clazz_index.find(clazz);
+    if(index == clazz_index.end() || (size_t) index->second >= vtable_layout.size()) {
+        return no_members;
+    }
+    return vtable_layout[index->second];
+}
+
+const Node *SymbolTable::get_single_implementation(TypeRef clazz, int slot) const {
+    size_t number = clazz.get_clazz();
+    if(!clazz.is_clazz() || number >= method_overridden.size() || slot < 0 
+        || (size_t) slot >= method_overridden[number].size() || method_overridden[number][slot]) {
+        return nullptr;
+    }
+    return vtable_layout[number][slot].decl;
 }
 
-Node SymbolTable::find_method(std::string cur_clazz, std::string id) {
+int SymbolTable::get_field_slot(std::string clazz, std::string id) const {
+    auto index = clazz_index.find(clazz);
+    if(index == clazz_index.end() || (size_t) index->second >= field_slot.size()) {
+        return -1;
+    }
+
+    auto slot = field_slot[index->second].find(id);
+    return (slot == field_slot[index->second].end()) ? -1 : slot->second;
+}
+
+int SymbolTable::get_method_slot(std::string clazz, std::string id) const {
+    auto index = clazz_index.find(clazz);
+    if(index == clazz_index.end() || (size_t) index->second >= method_slot.size()) {
+        return -1;
+    }
+
+    auto slot = method_slot[index->second].find(id);
+    return (slot == method_slot[index->second].end()) ? -1 : slot->second;
+}
 
-    std::vector<std::string> ancestors = get_all_ancestors(cur_clazz);
-    Node ret;
+const Node *SymbolTable::find_field(std::string cur_clazz, std::string id) const {
+    auto index = clazz_index.find(cur_clazz);
 
-    for(auto &anc : ancestors) {
-        ret = symbol_table[anc][METHOD][id];
-        if(!ret.is_empty()) {
+    if(index != clazz_index.end() && (size_t) index->second < field_slot.size()) {
+        // Flattened layout of the clazz
+        int slot = get_field_slot(cur_clazz, id);
+        if(slot < 0) {
+            return nullptr;
+        }
+        return field_layout[index->second][slot - 1].decl;
+    }
+
+    // Not in the hierarchy (cycle or undefined parent), walk the ancestors
+    for(auto &anc : get_all_ancestors(cur_clazz)) {
+        const Node *ret = lookup_member(anc, FIELD, id);
+        if(ret != nullptr) {
             return ret;
-        } else {
-            symbol_table[anc][METHOD].erase(id);
         }
     }
-    return Node();   
+    return nullptr;
+}
+
+const Node *SymbolTable::find_method(std::string cur_clazz, std::string id) const {
+    auto index = clazz_index.find(cur_clazz);
+
+    if(index != clazz_index.end() && (size_t) index->second < method_slot.size()) {
+        // Flattened layout of the clazz
+        int slot = get_method_slot(cur_clazz, id);
+        if(slot < 0) {
+            return nullptr;
+        }
+        return vtable_layout[index->second][slot].decl;
+    }
+
+    // Not in the hierarchy (cycle or undefined parent), walk the ancestors
+    for(auto &anc : get_all_ancestors(cur_clazz)) {
+        const Node *ret = lookup_member(anc, METHOD, id);
+        if(ret != nullptr) {
+            return ret;
+        }
+    }
+    return nullptr;   
 }
 
-void SymbolTable::print_symbol_table() {
+int SymbolTable::get_method_slot(TypeRef clazz, const std::string &id) const {
+    size_t number = clazz.get_clazz();
+    if(!clazz.is_clazz() || number >= method_slot.size()) {
+        return -1;
+    }
+
+    auto slot = method_slot[number].find(id);
+    return (slot == method_slot[number].end()) ? -1 : slot->second;
+}
+
+const Node *SymbolTable::find_method(TypeRef cur_clazz, const std::string &id) const {
+    if(!cur_clazz.is_clazz()) {
+        return nullptr;
+    }
+
+    size_t number = cur_clazz.get_clazz();
+    if(number >= indexed_clazz.size() || number >= method_slot.size()) {
+        // Not in the hierarchy
+        return find_method(get_type_name(cur_clazz), id);
+    }
+
+    int slot = get_method_slot(cur_clazz, id);
+    return (slot < 0) ? nullptr : vtable_layout[number][slot].decl;
+}
+
+void SymbolTable::print_symbol_table() const {
     for(const auto &clazz : symbol_table) {
         std::cout << clazz.first << " contains:" << std::endl;
 
-        for(const auto &field : symbol_table[clazz.first][FIELD]) {
-            std::cout << "\tField : " << field.first << std::endl;
+        for(const auto &field : get_fields_for(clazz.first)) {
+            std::cout << "\tField : " << field->get_data(DataType::id) << std::endl;
         } 
 
-        for(const auto &method : symbol_table[clazz.first][METHOD]) {
-            std::cout << "\tMethod: " << method.first << std::endl;
+        for(const auto &method : get_methods_for(clazz.first)) {
+            std::cout << "\tMethod: " << method->get_data(DataType::id) << std::endl;
         } 
     }
 }
 
-bool SymbolTable::is_parent_of_child(std::string parent, std::string child) {
-    std::vector<std::string> ancestors = get_all_ancestors(child);
-
-    return (std::find(ancestors.begin(), ancestors.end(), parent) != ancestors.end());
+bool SymbolTable::is_ancestor_index(int parent, int child) const {
+    // Parent interval encloses the child one
+    return pre_order[parent] <= pre_order[child] && post_order[child] <= post_order[parent];
 }
 
-bool SymbolTable::is_defined_clazz(std::string type) {
-    bool exist = !clazz_definition[type].is_empty();
-    if(!exist) {
-        clazz_definition.erase(type);
+bool SymbolTable::is_parent_of_child(std::string parent, std::string child) const {
+    auto p = clazz_index.find(parent);
+    auto c = clazz_index.find(child);
+
+    if(p != clazz_index.end() && c != clazz_index.end()) {
+        return is_ancestor_index(p->second, c->second);
+    }
+
+    if(c != clazz_index.end()) {
+        // An indexed clazz only inherits from indexed clazzes
+        return false;
     }
-    return exist;
-}
 
-void SymbolTable::update_clazz(Node &n) {
-    std::string id = n.get_data(DataType::id);
-    clazz_definition[id] = n; 
+    // Not in the hierarchy (basic type, cycle or undefined parent), walk the ancestors
+    std::vector<std::string> ancestors = get_all_ancestors(child);
+    return (std::find(ancestors.begin(), ancestors.end(), parent) != ancestors.end());
 }
 
-void SymbolTable::update_method(std::string clazz, Node &n) {
-    std::string id = n.get_data(DataType::id);
-    symbol_table[clazz][METHOD][id] = n; 
+bool SymbolTable::is_parent_of_child(TypeRef parent, TypeRef child) const {
+    if(!parent.is_clazz() || !child.is_clazz()) {
+        return false;
+    }
+
+    size_t p = parent.get_clazz();
+    size_t c = child.get_clazz();
+    if(p < indexed_clazz.size() && c < indexed_clazz.size()) {
+        return is_ancestor_index(p, c);
+    }
+    return is_parent_of_child(get_type_name(parent), get_type_name(child));
 }
 
-void SymbolTable::update_field(std::string clazz, Node &n) {
-    std::string id = n.get_data(DataType::id);
-    symbol_table[clazz][FIELD][id] = n; 
+bool SymbolTable::is_defined_clazz(std::string type) const {
+    return lookup_clazz(type) != nullptr;
 }
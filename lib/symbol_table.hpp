@@ -11,23 +11,94 @@
 
 #include "node.hpp"
 #include "error.hpp"
+#include "type_ref.hpp"
 
 #include <iostream>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #ifndef VSOPCOMPILER_SYMBOL_H
 #define VSOPCOMPILER_SYMBOL_H
 
+/*
+ * Member
+ *
+ * A field or method entry in the flattened layout of a clazz.
+ */
+struct Member {
+    std::string owner; // The clazz declaring (or overriding) the member
+    std::string id; // The name of the member
+    const Node *decl; // The member declaration in the abstract syntax tree
+};
+
 class SymbolTable // SymbolTable is a Singleton
 {
     private:
         static SymbolTable *instance; // The SymbolTable instance
         SymbolTable(); // SymbolTable constructor
+        bool frozen; // true once the SymbolTable has been frozen into a read-only snapshot
         
-        std::map<std::string, Node> clazz_definition; // A < class name - Node > mapping
-        std::vector<Node> clazz_in_cycle; // A vector of Node in a cycle
-        std::map<std::string, std::map<std::string, std::map<std::string, Node> > > symbol_table; // A < class name - method|field - id - Node > mapping
+        Node object; // The Object clazz, the only Node owned by the SymbolTable
+        std::map<std::string, const Node *> clazz_definition; // A < class name - Node > mapping
+        std::vector<const Node *> clazz_in_cycle; // A vector of Node in a cycle
+        std::map<std::string, std::map<std::string, std::map<std::string, const Node *> > > symbol_table; // A < class name - method|field - id - Node > mapping
+
+        std::unordered_map<std::string, const Node *> clazz_lookup; // A < class name - Node > hashed snapshot built by freeze
+        std::unordered_map<std::string, std::vector<std::string> > hierarchy_children; // A < class name - children inheriting from Object > mapping
+        std::unordered_map<std::string, int> clazz_index; // A < class name - hierarchy index > mapping
+        std::vector<int> pre_order; // The DFS pre-order number of each indexed clazz
+        std::vector<int> post_order; // The DFS post-order number of each indexed clazz
+        std::vector<std::string> indexed_clazz; // The name of each indexed clazz
+        std::vector<std::vector<int> > jump; // jump[k][i] is the 2^k-th ancestor of the indexed clazz i
+        std::unordered_map<std::string, int> clazz_number; // A < class name - clazz number > mapping, the indexed clazzes keeping their index
+        std::vector<std::string> numbered_clazz; // The name of each numbered clazz
+
+        std::vector<std::vector<Member> > field_layout; // The fields of each indexed clazz, inherited ones first
+        std::vector<std::vector<Member> > vtable_layout; // The methods of each indexed clazz, in vtable order
+        std::vector<std::unordered_map<std::string, int> > field_slot; // A < field name - structure index > mapping per indexed clazz
+        std::vector<std::unordered_map<std::string, int> > method_slot; // A < method name - vtable index > mapping per indexed clazz
+        std::vector<std::vector<bool> > method_overridden; // Whether a descendant overrides each vtable slot, per indexed clazz
+        const std::vector<Member> no_members; // The layout of a clazz out of the hierarchy
+
+        /*
+         * is_ancestor_index
+         *
+         * input:
+         *      parent - the hierarchy index of the parent class.
+         *      child - the hierarchy index of the child class.
+         * 
+         * return:
+         *      true if parent is an ancestor of child (or child itself),
+         *      false otherwise.
+         */
+        bool is_ancestor_index(int parent, int child) const;
+
+        /*
+         * lookup_clazz
+         *
+         * input:
+         *      clazz - the wanted clazz.
+         * 
+         * return:
+         *      a pointer to the clazz Node if defined,
+         *      nullptr otherwise.
+         */
+        const Node *lookup_clazz(const std::string &clazz) const;
+
+        /*
+         * lookup_member
+         *
+         * input:
+         *      clazz - the clazz declaring the member.
+         *      kind - either method or field.
+         *      id - the name of the member.
+         * 
+         * return:
+         *      a pointer to the member Node if declared by the clazz,
+         *      nullptr otherwise.
+         */
+        const Node *lookup_member(const std::string &clazz, const std::string &kind, const std::string &id) const;
 
     public:
         /*
@@ -38,60 +109,100 @@ class SymbolTable // SymbolTable is a Singleton
          */
         static SymbolTable *getInstance();
 
+        /*
+         * clear
+         *
+         * Forget every clazz but Object, so that a new AST can be checked.
+         */
+        void clear();
+
         /*
          * add_clazz_to_definition
          *
+         * The SymbolTable refers to the clazz node, which must outlive it and must not be moved.
+         *
          * input:
          *      clazz - the clazz node to add to the definition mapping.
          * 
          * return:
-         *      a node of the previously defined clazz (if any)
-         *      an empty node otherwise  
+         *      a pointer to the previously defined clazz (if any)
+         *      nullptr otherwise  
          */
-        Node add_clazz_to_definition(Node clazz);
+        const Node *add_clazz_to_definition(const Node &clazz);
 
         /*
          * add_method_to_clazz
          *
          * input:
          *      clazz - the clazz to add to the Node to.
-         *      n - the method Node to add.
+         *      n - the method Node to add, referred to like the clazz nodes.
          * 
          * return:
-         *      a node of the previously defined method for that clazz (if any)
-         *      an empty node otherwise  
+         *      a pointer to the previously defined method for that clazz (if any)
+         *      nullptr otherwise  
          */
-        Node add_method_to_clazz(std::string clazz, Node n);
+        const Node *add_method_to_clazz(std::string clazz, const Node &n);
 
         /*
          * add_field_to_clazz
          *
          * input:
          *      clazz - the clazz to add to the Node to.
-         *      n - the field Node to add.
+         *      n - the field Node to add, referred to like the clazz nodes.
          * 
          * return:
-         *      a node of the previously defined field for that clazz (if any)
-         *      an empty node otherwise  
+         *      a pointer to the previously defined field for that clazz (if any)
+         *      nullptr otherwise  
          */
-        Node add_field_to_clazz(std::string clazz, Node n);
+        const Node *add_field_to_clazz(std::string clazz, const Node &n);
 
         /*
          * cyclic_clazz_definition
          *
+         * Colour the parent graph in a single pass: each clazz either inherits from Object, 
+         * references a cycle or references an undefined class. The clazzes inheriting from 
+         * Object are kept for build_hierarchy.
+         *
          * return:
          *      0  - no cycle in class definition,
          *     -1  - otherwise.
          */
         int cyclic_clazz_definition();
 
+        /*
+         * build_hierarchy
+         *
+         * Number the clazzes inheriting (directly or not) from Object in DFS pre and post order,
+         * and build the ancestor jump table used for common ancestor queries. Every defined clazz
+         * also gets the clazz number of its TypeRef.
+         * Must be called after cyclic_clazz_definition.
+         */
+        void build_hierarchy();
+
+        /*
+         * build_layouts
+         *
+         * Flatten the fields and methods of each clazz of the hierarchy, parents first.
+         * Must be called after build_hierarchy, once fields and methods have been added.
+         */
+        void build_layouts();
+
+        /*
+         * freeze
+         *
+         * Turn the SymbolTable into a read-only snapshot with hashed lookups. Once frozen, 
+         * no clazz or member must be added, and all the const methods can be called concurrently.
+         * Must be called once all clazzes, fields and methods have been added.
+         */
+        void freeze();
+
         /*
          * get_cycle
          *
          * return:
          *      a vector of the nodes referencing a cycle
          */
-        std::vector<Node> get_cycle();
+        std::vector<const Node *> get_cycle() const;
 
         /*
          * get_undefined_parents
@@ -99,7 +210,7 @@ class SymbolTable // SymbolTable is a Singleton
          * return:
          *      a vector of the clazz nodes referencing an undefined class.
          */
-        std::vector<Node> get_undefined_parents();
+        std::vector<const Node *> get_undefined_parents() const;
 
         /*
          * get_defined_clazzes
@@ -107,7 +218,7 @@ class SymbolTable // SymbolTable is a Singleton
          * return:
          *      a vector of the clazz nodes referencing a defined class.
          */
-        std::vector<Node> get_defined_clazzes(bool with_Object = false);
+        std::vector<const Node *> get_defined_clazzes(bool with_Object = false) const;
 
         /*
          * get_clazz
@@ -116,9 +227,10 @@ class SymbolTable // SymbolTable is a Singleton
          *      clazz - the wanted clazz.
          * 
          * return:
-         *      the Node representing the clazz in the abstart syntax tree.
+         *      a pointer to the Node representing the clazz in the abstart syntax tree,
+         *      nullptr if undefined.
          */
-        Node get_clazz(std::string clazz);
+        const Node *get_clazz(std::string clazz) const;
 
         /*
          * get_fields_for
@@ -129,7 +241,7 @@ class SymbolTable // SymbolTable is a Singleton
          * return:
          *      a vector of Node representing the fields declared (not inherited) for the input clazz.
          */
-        std::vector<Node> get_fields_for(std::string clazz);
+        std::vector<const Node *> get_fields_for(std::string clazz) const;
 
         /*
          * get_methods_for
@@ -140,17 +252,113 @@ class SymbolTable // SymbolTable is a Singleton
          * return:
          *      a vector of Node representing the methods declared (not inherited) for the input clazz.
          */
-        std::vector<Node> get_methods_for(std::string clazz);
+        std::vector<const Node *> get_methods_for(std::string clazz) const;
+
+        /*
+         * get_field_layout
+         *
+         * input:
+         *      clazz - the wanted clazz.
+         * 
+         * return:
+         *      the fields (inherited first) of the clazz in structure order,
+         *      the field at position i being stored at structure index i + 1 (0 is the vtable).
+         *      The reference stays valid until the hierarchy is rebuilt.
+         */
+        const std::vector<Member> &get_field_layout(const std::string &clazz) const;
+
+        /*
+         * get_vtable_layout
+         *
+         * input:
+         *      clazz - the wanted clazz.
+         * 
+         * return:
+         *      the methods (inherited first) of the clazz in vtable order, with their implementing clazz.
+         *      The reference stays valid until the hierarchy is rebuilt.
+         */
+        const std::vector<Member> &get_vtable_layout(const std::string &clazz) const;
+
+        /*
+         * get_single_implementation
+         *
+         * input:
+         *      clazz - the static clazz of a receiver.
+         *      slot - the vtable index of the called method.
+         * 
+         * return:
+         *      a pointer to the only method declaration a receiver of the clazz (or of any descendant) can dispatch to,
+         *      nullptr if a descendant overrides it.
+         */
+        const Node *get_single_implementation(TypeRef clazz, int slot) const;
+
+        /*
+         * get_field_slot
+         *
+         * input:
+         *      clazz - the clazz scope.
+         *      id - the name of the field.
+         * 
+         * return:
+         *      the structure index of the field for the clazz if any,
+         *      -1 otherwise.
+         */
+        int get_field_slot(std::string clazz, std::string id) const;
+
+        /*
+         * get_method_slot
+         *
+         * input:
+         *      clazz - the clazz scope.
+         *      id - the name of the method.
+         * 
+         * return:
+         *      the vtable index of the method for the clazz if any,
+         *      -1 otherwise.
+         */
+        int get_method_slot(std::string clazz, std::string id) const;
+        int get_method_slot(TypeRef clazz, const std::string &id) const;
 
         /*
          * get_main_method
          *
          * return:
-         *      a clazz node named 'Main' if any,
-         *      an empty node otherwise. 
+         *      a pointer to the 'main' method of the clazz 'Main' if any,
+         *      nullptr otherwise. 
          */
-        Node get_main_method();
+        const Node *get_main_method() const;
     
+        /*
+         * get_type_ref
+         *
+         * input:
+         *      type - the name of a type.
+         * 
+         * return:
+         *      the interned type if primitive or defined clazz,
+         *      none otherwise.
+         */
+        TypeRef get_type_ref(const std::string &type) const;
+
+        /*
+         * get_type_name
+         *
+         * input:
+         *      t - an interned type.
+         * 
+         * return:
+         *      the name of the type, an empty string for none.
+         */
+        std::string get_type_name(TypeRef t) const;
+
+        /*
+         * get_clazz_count
+         *
+         * return:
+         *      the number of numbered clazzes (Object included).
+         */
+        size_t get_clazz_count() const;
+
         /*
          * get_all_ancestors
          *
@@ -160,7 +368,7 @@ class SymbolTable // SymbolTable is a Singleton
          * return:
          *      a vector of ancestor classes in order of inheritance (child before parent).
          */
-        std::vector<std::string> get_all_ancestors(std::string a);
+        std::vector<std::string> get_all_ancestors(std::string a) const;
 
         /*
          * find_common_ancestor
@@ -172,7 +380,8 @@ class SymbolTable // SymbolTable is a Singleton
          *      the common ancestor if any,
          *      an empty string otherwise (happens when loop).
          */
-        std::string find_common_ancestor(std::string a, std::string b);
+        std::string find_common_ancestor(std::string a, std::string b) const;
+        TypeRef find_common_ancestor(TypeRef a, TypeRef b) const;
 
         /*
          * find_field
@@ -182,10 +391,10 @@ class SymbolTable // SymbolTable is a Singleton
          *      id - the name of the field.
          * 
          * return:
-         *      The field node in the scope if any,
-         *      an empty Node otherwise.
+         *      a pointer to the field node in the scope if any,
+         *      nullptr otherwise.
          */
-        Node find_field(std::string cur_clazz, std::string id);
+        const Node *find_field(std::string cur_clazz, std::string id) const;
 
         /*
          * find_method
@@ -195,10 +404,11 @@ class SymbolTable // SymbolTable is a Singleton
          *      id - the name of the method.
          * 
          * return:
-         *      The method node in the scope if any,
-         *      an empty Node otherwise.
+         *      a pointer to the method node in the scope if any,
+         *      nullptr otherwise.
          */
-        Node find_method(std::string cur_clazz, std::string id);
+        const Node *find_method(std::string cur_clazz, std::string id) const;
+        const Node *find_method(TypeRef cur_clazz, const std::string &id) const;
 
         /*
          * is_parent_of_child
@@ -211,7 +421,8 @@ class SymbolTable // SymbolTable is a Singleton
          *      true if parent is an ancestor of child,
          *      false otherwise.
          */
-        bool is_parent_of_child(std::string parent, std::string child);
+        bool is_parent_of_child(std::string parent, std::string child) const;
+        bool is_parent_of_child(TypeRef parent, TypeRef child) const;
 
         /*
          * is_defined_clazz
@@ -223,46 +434,14 @@ class SymbolTable // SymbolTable is a Singleton
          *      true if class has been defined,
          *      false otherwise.
          */
-        bool is_defined_clazz(std::string type);
-
-        /*
-         * update_clazz
-         *
-         * input:
-         *      n - the clazz Node.
-         * 
-         * Update the clazz representation in the data structures.
-         */
-        void update_clazz(Node &n);
-
-        /*
-         * update_method
-         *
-         * input:
-         *      clazz - the clazz to update.
-         *      n - a reference to the method Node.
-         * 
-         * Update the method representation for the clazz in the data structures.
-         */
-        void update_method(std::string clazz, Node &n);
-
-        /*
-         * update_field
-         *
-         * input:
-         *      clazz - the clazz to update.
-         *      n - a reference to the field Node.
-         * 
-         * Update the field representation for the clazz in the data structures.
-         */
-        void update_field(std::string clazz, Node &n);
+        bool is_defined_clazz(std::string type) const;
 
         /*
          * is_parent_of_child
          *
          * Print the symbol_table content.
          */
-        void print_symbol_table();
+        void print_symbol_table() const;
 };
 
 #endif //VSOPCOMPILER_SYMBOL_H
\ No newline at end of file
@@ -0,0 +1,73 @@
+/*
+ * type_ref.cpp
+ *
+ * by Antoine Boonen
+ *
+ * This file contains the implementation of the TypeRef class as described in the interface 'type_ref.h'.
+ *
+ * Created   19/10/26
+ * Modified  19/10/26
+ */
+#include "type_ref.hpp"
+
+#include <string>
+
+TypeRef::TypeRef(int i) {
+    id = i;
+}
+
+TypeRef TypeRef::clazz(int number) {
+    return TypeRef(first_clazz + number);
+}
+
+TypeRef TypeRef::of_primitive(const std::string &type) {
+    if(type == "int32") {
+        return TypeRef(int32);
+    } else if(type == "bool") {
+        return TypeRef(boolean);
+    } else if(type == "string") {
+        return TypeRef(string);
+    } else if(type == "unit") {
+        return TypeRef(unit);
+    }
+    return TypeRef(none);
+}
+
+bool TypeRef::is_none() const {
+    return id == none;
+}
+
+bool TypeRef::is_clazz() const {
+    return id >= first_clazz;
+}
+
+int TypeRef::get_clazz() const {
+    return is_clazz() ? id - first_clazz : -1;
+}
+
+std::string TypeRef::get_primitive_name() const {
+    switch(id) {
+        case unit:
+            return "unit";
+        case boolean:
+            return "bool";
+        case int32:
+            return "int32";
+        case string:
+            return "string";
+        default:
+            return std::string();
+    }
+}
+
+bool TypeRef::operator==(const TypeRef &other) const {
+    return id == other.id;
+}
+
+bool TypeRef::operator!=(const TypeRef &other) const {
+    return id != other.id;
+}
+
+bool TypeRef::operator<(const TypeRef &other) const {
+    return id < other.id;
+}
@@ -0,0 +1,97 @@
+/*
+ * type_ref.h
+ *
+ * by Antoine Boonen
+ *
+ * This file contains the interface of the TypeRef class.
+ *
+ * Created   19/10/26
+ * Modified  19/10/26
+ */
+
+#include <iostream>
+
+#ifndef VSOPCOMPILER_TYPE_REF_H
+#define VSOPCOMPILER_TYPE_REF_H
+
+/*
+ * TypeRef
+ *
+ * An interned type: either a primitive type or a clazz number given by the SymbolTable
+ * (the hierarchy index for the clazzes inheriting from Object, Object being 0).
+ */
+class TypeRef {
+    private:
+        int id; // The primitive type, or first_clazz plus the clazz number
+
+    public:
+        enum : int { none = 0, unit, boolean, int32, string, first_clazz };
+
+        /*
+         * TypeRef constructor
+         *
+         * input:
+         *      i - a primitive type (none by default).
+         * 
+         * return:
+         *      A TypeRef instance.
+         */
+        TypeRef(int i = none);
+
+        /*
+         * clazz
+         *
+         * input:
+         *      number - the clazz number.
+         * 
+         * return:
+         *      the TypeRef of the clazz.
+         */
+        static TypeRef clazz(int number);
+
+        /*
+         * of_primitive
+         *
+         * input:
+         *      type - the name of a type.
+         * 
+         * return:
+         *      the TypeRef of the primitive type if type is one,
+         *      none otherwise.
+         */
+        static TypeRef of_primitive(const std::string &type);
+
+        /*
+         * is_none, is_clazz
+         *
+         * return:
+         *      true if the TypeRef is none (resp. a clazz),
+         *      false otherwise.
+         */
+        bool is_none() const;
+        bool is_clazz() const;
+
+        /*
+         * get_clazz
+         *
+         * return:
+         *      the clazz number if the TypeRef is a clazz,
+         *      -1 otherwise.
+         */
+        int get_clazz() const;
+
+        /*
+         * get_primitive_name
+         *
+         * return:
+         *      the name of the primitive type,
+         *      an empty string if the TypeRef is none or a clazz.
+         */
+        std::string get_primitive_name() const;
+
+        bool operator==(const TypeRef &other) const;
+        bool operator!=(const TypeRef &other) const;
+        bool operator<(const TypeRef &other) const;
+};
+
+#endif //VSOPCOMPILER_TYPE_REF_H
@@ -10,10 +10,27 @@
  */
 #include "external.h"
 
-int64_t power(int32_t x, int32_t y) {
-    int64_t pow = x;
-    for(int i = 1; i < y; ++i) {
-        pow *= x;
+#include <inttypes.h>
+#include <stdio.h>
+
+static FILE *profile = NULL; // The profile file being written
+
+void profile_begin(const char *filename) {
+    profile = fopen(filename, "w");
+    if(!profile) {
+        fprintf(stderr, "Cannot write the profile in %s\n", filename);
+    }
+}
+
+void profile_count(int32_t site, const char *clazz, int64_t count) {
+    if(profile && count > 0) {
+        fprintf(profile, "%" PRId32 " %s %" PRId64 "\n", site, clazz, count);
+    }
+}
+
+void profile_end(void) {
+    if(profile) {
+        fclose(profile);
+        profile = NULL;
     }
-    return pow;
 }
@@ -14,10 +14,24 @@
 #include <stdint.h>
 
 /*
- * power
+ * profile_begin
  *
- * returns (x^y)
+ * Open (truncate) the profile file of an instrumented program.
  */
-int64_t power(int32_t x, int32_t y);
+void profile_begin(const char *filename);
+
+/*
+ * profile_count
+ *
+ * Write that the call site received count calls on an instance of clazz.
+ */
+void profile_count(int32_t site, const char *clazz, int64_t count);
+
+/*
+ * profile_end
+ *
+ * Close the profile file.
+ */
+void profile_end(void);
 
 #endif//POWER_H_
@@ -46,7 +46,7 @@ int32_t Object__inputInt32(Object *self);
 
 
 // Object's constructor. Allocates and initialize a new Object.
-Object *Object__new(void);
+Object *Object___new(void);
 
 // Object's initializer. Initializes an allocated Object.
 Object *Object___init(Object *self);
@@ -0,0 +1,98 @@
+#!/bin/sh
+#
+# run_tests.sh
+#
+# by Antoine Boonen
+#
+# Run the regression checks of vsopc (make test). Each check prints 'ok' or 'FAIL',
+# the script fails if any check does.
+#
+
+VSOPC=${VSOPC:-./vsopc}
+TMP=${TMP:-/tmp/vsopc}
+failures=0
+
+mkdir -p $TMP
+
+# check <name> <command...>
+check() {
+    name=$1
+    shift
+    if "$@" > /dev/null 2>&1; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name"
+        failures=$((failures + 1))
+    fi
+}
+
+# prints <expected> <command...>
+prints() {
+    expected=$1
+    shift
+    [ "$("$@")" = "$expected" ]
+}
+
+# function_ir <ir file> <function>: print the IR of the function
+function_ir() {
+    awk -v f="@$2(" 'index($0, "define") == 1 && index($0, f) { p = 1 } p { print } p && /^}/ { p = 0 }' $1
+}
+
+# allocates <ir file> <function> <size>
+allocates() {
+    function_ir $1 $2 | grep -q "call i8\* @malloc(i64 $3)"
+}
+
+# on_stack <ir file> <function>: the objects of the function are all on the stack
+on_stack() {
+    function_ir $1 $2 | grep -q "%object" && ! function_ir $1 $2 | grep -q "@malloc"
+}
+
+# on_heap <ir file> <function>: an object of the function is on the heap
+on_heap() {
+    function_ir $1 $2 | grep -q "@malloc"
+}
+
+########################## Allocations ##########################
+
+# Right-sized objects
+$VSOPC -i tests/alloc.vsop > $TMP/alloc.ll 2> /dev/null
+check "alloc: Empty size" allocates $TMP/alloc.ll Empty___new 8
+check "alloc: Pair size" allocates $TMP/alloc.ll Pair___new 16
+check "alloc: Cell size" allocates $TMP/alloc.ll Cell___new 24
+check "alloc: Wide size" allocates $TMP/alloc.ll Wide___new 40
+check "alloc: Main size" allocates $TMP/alloc.ll Main___new 8
+check "alloc: run" prints 1000000 $VSOPC -O2 --run tests/alloc.vsop
+
+# Objects moved to the stack by the escape analysis, once inlined
+$VSOPC --passes='cgscc(inline),function(mem2reg,stack-alloc)' -i tests/escape.vsop > $TMP/escape.ll 2> /dev/null
+check "escape: local on the stack" on_stack $TMP/escape.ll Main__local
+check "escape: loop on the stack" on_stack $TMP/escape.ll Main__loop
+check "escape: returned on the heap" on_heap $TMP/escape.ll Main__returned
+check "escape: stored on the heap" on_heap $TMP/escape.ll Main__stored
+check "escape: carried on the heap" on_heap $TMP/escape.ll Main__carried
+check "escape: big on the heap" on_heap $TMP/escape.ll Main__big
+check "escape: run" prints 43 $VSOPC -O2 --run tests/escape.vsop
+
+########################## Deep ASTs ##########################
+
+# 1 + 1 + ... + 1 over 100k terms, generated and checked on new stack segments
+awk 'BEGIN { printf "class Main { main() : int32 { 1"; for(i = 1; i < 100000; ++i) printf " + 1"; print " - 100000 } }" }' > $TMP/deep.vsop
+check "deep expression: check" $VSOPC -c $TMP/deep.vsop
+check "deep expression: llvm" $VSOPC -i $TMP/deep.vsop
+check "deep expression: run" $VSOPC -O1 --run $TMP/deep.vsop
+
+# let x0 : int32 <- 0 in let x1 : int32 <- x0 + 1 in ... over 40k lets, each binding a new variable
+awk 'BEGIN { printf "class Main { main() : int32 {"; for(i = 0; i < 40000; ++i) printf " let x%d : int32 <- %s in", i, (i ? "x" (i - 1) " + 1" : "0"); print " x39999 - 39999 } }" }' > $TMP/lets.vsop
+check "deep lets: check" $VSOPC -c $TMP/lets.vsop
+check "deep lets: run" $VSOPC -O1 --run $TMP/lets.vsop
+
+# let x : int32 <- 0 in let x : int32 <- x + 1 in ... over 40k lets, each shadowing the previous one
+awk 'BEGIN { printf "class Main { main() : int32 { let x : int32 <- 0 in"; for(i = 1; i < 40000; ++i) printf " let x : int32 <- x + 1 in"; print " x - 39999 } }" }' > $TMP/shadowing.vsop
+check "shadowing lets: check" $VSOPC -c $TMP/shadowing.vsop
+check "shadowing lets: run" $VSOPC -O1 --run $TMP/shadowing.vsop
+
+if [ $failures -ne 0 ]; then
+    echo "$failures check(s) failed"
+    exit 1
+fi